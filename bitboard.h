@@ -0,0 +1,170 @@
+#ifndef BITBOARD_H_
+#define BITBOARD_H_
+
+#include <cstddef>  // for std::size_t, std::ptrdiff_t
+#include <cstdint>  // for std::uint16_t, std::uint64_t
+#include <iterator>  // for std::forward_iterator_tag
+
+// set of the 81 cells of a board, indexed 0 to 80 in row order
+//
+// Rows 1 to 7 are kept in the low word and rows 8 and 9 in the high word,
+// so that a whole row never straddles the two words and can be read out
+// with one shift.
+class Bitboard {
+ public:
+  class const_iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const std::size_t *;
+    using reference = std::size_t;
+
+    const_iterator(std::uint64_t lo, std::uint64_t hi) : lo_(lo), hi_(hi) {}
+
+    std::size_t operator*() const {
+      return lo_ ? __builtin_ctzll(lo_) : kLoCells + __builtin_ctzll(hi_);
+    }
+
+    const_iterator& operator++() {
+      if (lo_)
+        lo_ &= lo_ - 1;
+      else
+        hi_ &= hi_ - 1;
+      return *this;
+    }
+
+    const_iterator operator++(int) {
+      const_iterator previous = *this;
+      ++*this;
+      return previous;
+    }
+
+    bool operator==(const const_iterator& other) const {
+      return lo_ == other.lo_ && hi_ == other.hi_;
+    }
+
+    bool operator!=(const const_iterator& other) const {
+      return !(*this == other);
+    }
+
+   private:
+    std::uint64_t lo_;
+    std::uint64_t hi_;
+  };
+
+  using iterator = const_iterator;
+
+  Bitboard() : lo_(0), hi_(0) {}
+
+  // the cells of one row, column, or box, numbered from 1 like Board's
+  static Bitboard Row(std::size_t row_num) {
+    return row_num <= kLoRows
+      ? Bitboard(std::uint64_t{0x1ff} << ((row_num - 1) * 9), 0)
+      : Bitboard(0, std::uint64_t{0x1ff} << ((row_num - 1 - kLoRows) * 9));
+  }
+
+  static Bitboard Column(std::size_t col_num) {
+    Bitboard result;
+    for (std::size_t i = 0; i < 9; ++i)
+      result.insert(i * 9 + col_num - 1);
+    return result;
+  }
+
+  static Bitboard Box(std::size_t box_num) {
+    std::size_t corner = (box_num - 1) / 3 * 27 + (box_num - 1) % 3 * 3;
+    Bitboard result;
+    for (std::size_t i = 0; i < 9; ++i)
+      result.insert(corner + i / 3 * 9 + i % 3);
+    return result;
+  }
+
+  // bit n - 1 is set if column n of the row is in the set
+  std::uint16_t RowBits(std::size_t row_num) const {
+    return row_num <= kLoRows
+      ? (lo_ >> ((row_num - 1) * 9)) & 0x1ff
+      : (hi_ >> ((row_num - 1 - kLoRows) * 9)) & 0x1ff;
+  }
+
+  // bit n - 1 is set if row n of the column is in the set
+  std::uint16_t ColumnBits(std::size_t col_num) const {
+    std::uint16_t result = 0;
+    for (std::size_t i = 0; i < 9; ++i)
+      result |= ((RowBits(i + 1) >> (col_num - 1)) & 1) << i;
+    return result;
+  }
+
+  std::size_t size() const {
+    return __builtin_popcountll(lo_) + __builtin_popcountll(hi_);
+  }
+
+  bool empty() const { return (lo_ | hi_) == 0; }
+
+  std::size_t count(std::size_t index) const {
+    return index < kLoCells ? (lo_ >> index) & 1
+                            : (hi_ >> (index - kLoCells)) & 1;
+  }
+
+  void insert(std::size_t index) {
+    if (index < kLoCells)
+      lo_ |= std::uint64_t{1} << index;
+    else
+      hi_ |= std::uint64_t{1} << (index - kLoCells);
+  }
+
+  void erase(std::size_t index) {
+    if (index < kLoCells)
+      lo_ &= ~(std::uint64_t{1} << index);
+    else
+      hi_ &= ~(std::uint64_t{1} << (index - kLoCells));
+  }
+
+  const_iterator begin() const { return const_iterator(lo_, hi_); }
+  const_iterator end() const { return const_iterator(0, 0); }
+  const_iterator cbegin() const { return begin(); }
+  const_iterator cend() const { return end(); }
+
+  Bitboard operator&(const Bitboard& other) const {
+    return Bitboard(lo_ & other.lo_, hi_ & other.hi_);
+  }
+
+  Bitboard operator|(const Bitboard& other) const {
+    return Bitboard(lo_ | other.lo_, hi_ | other.hi_);
+  }
+
+  // the complement, within the 81 cells
+  Bitboard operator~() const {
+    return Bitboard(~lo_ & kLoAll, ~hi_ & kHiAll);
+  }
+
+  Bitboard& operator&=(const Bitboard& other) {
+    lo_ &= other.lo_;
+    hi_ &= other.hi_;
+    return *this;
+  }
+
+  Bitboard& operator|=(const Bitboard& other) {
+    lo_ |= other.lo_;
+    hi_ |= other.hi_;
+    return *this;
+  }
+
+  bool operator==(const Bitboard& other) const {
+    return lo_ == other.lo_ && hi_ == other.hi_;
+  }
+
+  bool operator!=(const Bitboard& other) const { return !(*this == other); }
+
+ private:
+  static constexpr std::size_t kLoRows = 7;
+  static constexpr std::size_t kLoCells = kLoRows * 9;
+  static constexpr std::uint64_t kLoAll = (std::uint64_t{1} << kLoCells) - 1;
+  static constexpr std::uint64_t kHiAll = (std::uint64_t{1} << 18) - 1;
+
+  Bitboard(std::uint64_t lo, std::uint64_t hi) : lo_(lo), hi_(hi) {}
+
+  std::uint64_t lo_;
+  std::uint64_t hi_;
+};
+
+#endif
@@ -1,10 +1,9 @@
-#include <algorithm>  // for std::all_of
+#include <cstdint>  // for std::uint16_t
 #include <stdexcept>  // for std::invalid_argument
-#include <unordered_set>
 
 #include "board.h"
 
-Board::Board() {
+Board::Board() : layout_(Layout::Standard()), trail_(nullptr) {
   for (std::size_t i = 1; i <= 9; ++i) {
     BoardRow row;
 
@@ -16,10 +15,11 @@ Board::Board() {
     data_.push_back(row);
   }
 
-  InitializeBoxLookup();
+  InitializeCandidates();
 }
 
-Board::Board(const std::vector<std::vector<int>>& data) {
+Board::Board(const std::vector<std::vector<int>>& data)
+    : layout_(Layout::Standard()), trail_(nullptr) {
   const std::string kBoardSizeMessage =
     "There must be exactly 9 rows and columns in the input data.";
 
@@ -42,47 +42,150 @@ Board::Board(const std::vector<std::vector<int>>& data) {
     data_.push_back(new_row);
   }
 
-  InitializeBoxLookup();
+  InitializeCandidates();
+}
+
+Board::Board(const std::array<int, 81>& clues)
+    : layout_(Layout::Standard()), trail_(nullptr) {
+  for (std::size_t i = 1; i <= 9; ++i) {
+    BoardRow row;
+    row.reserve(9);
+
+    for (std::size_t j = 1; j <= 9; ++j)
+      row.emplace_back(i, j, clues[(i - 1) * 9 + (j - 1)]);
+
+    data_.push_back(row);
+  }
+
+  InitializeCandidates();
+}
+
+// the copy keeps its own trail, if any, or none for a new board
+Board::Board(const Board& other)
+    : data_(other.data_), layout_(other.layout_),
+      candidates_(other.candidates_), trail_(nullptr) {}
+
+Board& Board::operator=(const Board& other) {
+  data_ = other.data_;
+  layout_ = other.layout_;
+  candidates_ = other.candidates_;
+  return *this;
 }
 
 Board::BoardValidationResult Board::Validate() const {
+  std::array<int, 81> grid;
+  for (std::size_t i = 0; i < 9; ++i) {
+    for (std::size_t j = 0; j < 9; ++j) {
+      const Cell& cell = data_[i][j];
+      grid[i * 9 + j] = cell.solved() ? cell.solution() : 0;
+    }
+  }
+
+  return ValidateGrid(grid, *layout_);
+}
+
+Board::BoardValidationResult Board::ValidateGrid(
+    const std::array<int, 81>& grid, const Layout& layout) {
   // check that each row, column, and box has no duplicate numbers
+  //
+  // Each unit keeps one bit per digit seen so far, and a bit per digit
+  // seen twice. The loops have no branches, so the compiler can vectorize
+  // them; the units are only looked at one by one if something is wrong.
+
+  std::array<std::uint16_t, 81> bits;
+  std::uint16_t any_blank = 0;
+  for (std::size_t i = 0; i < 81; ++i) {
+    bits[i] = static_cast<std::uint16_t>((1u << grid[i]) & ~1u);
+    any_blank |= bits[i] == 0;
+  }
 
-  for (std::size_t i = 1; i <= 9; ++i) {
-    auto cell_list = row(i);
-    if (auto result = ValidateCellList(cell_list); !result.valid) {
-      std::string message = "Row " + std::to_string(i) + " is invalid: " +
-        "Duplicate " + std::to_string(result.duplicate_solution) + "'s";
-      return BoardValidationResult::Invalid(message);
+  std::array<std::uint16_t, 9> row_seen{}, col_seen{}, box_seen{};
+  std::array<std::uint16_t, 9> row_dups{}, col_dups{}, box_dups{};
+  for (std::size_t i = 0; i < 9; ++i) {
+    for (std::size_t j = 0; j < 9; ++j) {
+      std::uint16_t bit = bits[i * 9 + j];
+      row_dups[i] |= row_seen[i] & bit;
+      row_seen[i] |= bit;
+      col_dups[j] |= col_seen[j] & bit;
+      col_seen[j] |= bit;
     }
   }
 
-  for (std::size_t i = 1; i <= 9; ++i) {
-    auto cell_list = col(i);
-    if (auto result = ValidateCellList(cell_list); !result.valid) {
-      std::string message = "Column " + std::to_string(i) + " is invalid: " +
-        "Duplicate " + std::to_string(result.duplicate_solution) + "'s";
-      return BoardValidationResult::Invalid(message);
+  for (std::size_t i = 0; i < 9; ++i) {
+    for (std::size_t j = 0; j < 9; ++j) {
+      std::uint16_t bit = bits[(i / 3 * 3 + j / 3) * 9 + i % 3 * 3 + j % 3];
+      box_dups[i] |= box_seen[i] & bit;
+      box_seen[i] |= bit;
     }
   }
 
-  for (std::size_t i = 1; i <= 9; ++i) {
-    auto cell_list = box(i);
-    if (auto result = ValidateCellList(cell_list); !result.valid) {
-      std::string message = "Box " + std::to_string(i) + " is invalid: " +
-        "Duplicate " + std::to_string(result.duplicate_solution) + "'s";
-      return BoardValidationResult::Invalid(message);
+  std::uint16_t any_dups = 0;
+  for (std::size_t i = 0; i < 9; ++i)
+    any_dups |= row_dups[i] | col_dups[i] | box_dups[i];
+
+  if (any_dups) {
+    // rows, then columns, then boxes, which are the layout's first units;
+    // the digit reported is the first to repeat in the unit's cells, not
+    // the lowest one that does
+    const std::array<std::uint16_t, 9> *unit_dups[] = {
+      &row_dups, &col_dups, &box_dups
+    };
+    const std::string kUnitNames[] = {"Row", "Column", "Box"};
+
+    for (std::size_t kind = 0; kind < 3; ++kind) {
+      for (std::size_t i = 0; i < 9; ++i) {
+        if ((*unit_dups[kind])[i] != 0) {
+          int duplicate_solution = 0;
+          std::uint16_t seen = 0;
+          for (std::size_t index : layout.units()[kind * 9 + i].cells) {
+            if (seen & bits[index]) {
+              duplicate_solution = grid[index];
+              break;
+            }
+            seen |= bits[index];
+          }
+
+          std::string message = kUnitNames[kind] + " " +
+            std::to_string(i + 1) + " is invalid: " +
+            "Duplicate " + std::to_string(duplicate_solution) + "'s";
+          return BoardValidationResult::Invalid(message);
+        }
+      }
+    }
+  }
+
+  // the units a variant adds come after the rows, columns, and boxes, and
+  // there are few enough of them to check one by one
+  const auto& units = layout.units();
+  for (std::size_t i = 27; i < units.size(); ++i) {
+    const Layout::Unit& unit = units[i];
+    std::uint16_t seen = 0;
+    int sum = 0;
+    bool filled = true;
+
+    for (std::size_t index : unit.cells) {
+      if (seen & bits[index]) {
+        return BoardValidationResult::Invalid(
+            unit.Name() + " is invalid: Duplicate " +
+            std::to_string(grid[index]) + "'s");
+      }
+      seen |= bits[index];
+      sum += grid[index];
+      filled = filled && grid[index] != 0;
+    }
+
+    if (unit.sum > 0 && (sum > unit.sum || (filled && sum != unit.sum))) {
+      return BoardValidationResult::Invalid(
+          unit.Name() + " is invalid: Adds up to " + std::to_string(sum) +
+          ", not " + std::to_string(unit.sum));
     }
   }
 
   // if execution gets here, there were no duplicate solutions
   // check if it's complete
 
-  for (auto row : data_) {
-    if (std::any_of(row.cbegin(), row.cend(),
-                    [](const Cell& cell){ return !cell.solved(); }))
-      return BoardValidationResult::ValidUnsolved();
-  }
+  if (any_blank)
+    return BoardValidationResult::ValidUnsolved();
 
   return BoardValidationResult::Solved();
 }
@@ -92,6 +195,77 @@ std::ostream& operator<<(std::ostream& os, const Board& board) {
   return os;
 }
 
+const Cell *Board::cell(std::size_t row_num, std::size_t col_num) const {
+  if (row_num < 1 || row_num > 9)
+    throw std::invalid_argument("Invalid row number");
+
+  if (col_num < 1 || col_num > 9)
+    throw std::invalid_argument("Invalid column number");
+
+  return &data_[row_num - 1][col_num - 1];
+}
+
+Cell *Board::cell(std::size_t row_num, std::size_t col_num) {
+  if (row_num < 1 || row_num > 9)
+    throw std::invalid_argument("Invalid row number");
+
+  if (col_num < 1 || col_num > 9)
+    throw std::invalid_argument("Invalid column number");
+
+  return &data_[row_num - 1][col_num - 1];
+}
+
+void Board::SetSolution(Cell *cell, int solution) {
+  if (trail_)
+    trail_->Record(this, cell);
+
+  cell->set_solution(solution);
+  UpdateCandidates(cell);
+}
+
+void Board::SetGuesses(Cell *cell, const Cell::CellGuesses& guesses) {
+  if (trail_)
+    trail_->Record(this, cell);
+
+  cell->set_guesses(guesses);
+  UpdateCandidates(cell);
+}
+
+void Board::RemoveGuess(Cell *cell, int guess) {
+  if (trail_)
+    trail_->Record(this, cell);
+
+  cell->remove_guess(guess);
+  UpdateCandidates(cell);
+}
+
+const Bitboard& Board::candidates(int digit) const {
+  if (digit < 1 || digit > 9)
+    throw std::invalid_argument("Invalid digit");
+
+  return candidates_[digit];
+}
+
+const Layout& Board::layout() const {
+  return *layout_;
+}
+
+const std::shared_ptr<const Layout>& Board::shared_layout() const {
+  return layout_;
+}
+
+void Board::set_layout(const std::shared_ptr<const Layout>& layout) {
+  layout_ = layout;
+}
+
+Trail *Board::trail() const {
+  return trail_;
+}
+
+void Board::set_trail(Trail *trail) {
+  trail_ = trail;
+}
+
 std::vector<const Cell *> Board::row(std::size_t row_num) const {
   if (row_num < 1 || row_num > 9)
     throw std::invalid_argument("Invalid row number");
@@ -140,59 +314,51 @@ std::vector<const Cell *> Board::box(std::size_t box_num) const {
   if (box_num < 1 || box_num > 9)
     throw std::invalid_argument("Invalid box number");
 
-  const Cell *box_corner = box_lookup_[box_num - 1];
-
-  std::vector<const Cell *> result;
-  for (std::size_t i = 0; i < 9; ++i)
-    result.push_back(&(data_[box_corner->row() - 1 + (i / 3)]
-                            [box_corner->col() - 1 + (i % 3)]));
-
-  return result;
+  // every layout starts with the rows, columns, and boxes
+  return unit(18 + box_num - 1);
 }
 
 std::vector<Cell *> Board::box(std::size_t box_num) {
   if (box_num < 1 || box_num > 9)
     throw std::invalid_argument("Invalid box number");
 
-  const Cell *box_corner = box_lookup_[box_num - 1];
+  return unit(18 + box_num - 1);
+}
 
-  std::vector<Cell *> result;
-  for (std::size_t i = 0; i < 9; ++i)
-    result.push_back(&(data_[box_corner->row() - 1 + (i / 3)]
-                            [box_corner->col() - 1 + (i % 3)]));
+std::vector<const Cell *> Board::unit(std::size_t unit_index) const {
+  std::vector<const Cell *> result;
+  for (std::size_t index : layout_->units().at(unit_index).cells)
+    result.push_back(&(data_[index / 9][index % 9]));
 
   return result;
 }
 
-Board::CellListValidationResult Board::ValidateCellList(
-    std::vector<const Cell *> cell_list) const {
-  std::unordered_set<int> solutions_in_list;
+std::vector<Cell *> Board::unit(std::size_t unit_index) {
+  std::vector<Cell *> result;
+  for (std::size_t index : layout_->units().at(unit_index).cells)
+    result.push_back(&(data_[index / 9][index % 9]));
 
-  for (const Cell *cell: cell_list) {
-    if (cell->solved()) {
-      auto insert_result = solutions_in_list.insert(cell->solution());
+  return result;
+}
 
-      // did the insertion fail?
-      if (!insert_result.second)
-        // if so, there was a duplicate solution in this cell list
-        return CellListValidationResult::Invalid(cell->solution());
-    }
+void Board::InitializeCandidates() {
+  for (Bitboard& candidates : candidates_)
+    candidates = Bitboard();
+
+  for (const auto& row : data_) {
+    for (const Cell& cell : row)
+      UpdateCandidates(&cell);
   }
+}
 
-  // if execution gets here, there were no duplicate solutions
-  return CellListValidationResult::Valid();
-}
-
-void Board::InitializeBoxLookup() {
-  box_lookup_ = {
-    &data_[0][0],
-    &data_[0][3],
-    &data_[0][6],
-    &data_[3][0],
-    &data_[3][3],
-    &data_[3][6],
-    &data_[6][0],
-    &data_[6][3],
-    &data_[6][6]
-  };
+void Board::UpdateCandidates(const Cell *cell) {
+  std::size_t index = (cell->row() - 1) * 9 + (cell->col() - 1);
+  std::uint16_t mask = cell->solved() ? 0 : cell->guesses().mask();
+
+  for (int digit = 1; digit <= 9; ++digit) {
+    if ((mask >> digit) & 1)
+      candidates_[digit].insert(index);
+    else
+      candidates_[digit].erase(index);
+  }
 }
@@ -1,14 +1,21 @@
 #ifndef BOARD_H_
 #define BOARD_H_
 
+#include <array>
+#include <cstdint>  // for std::uint16_t
 #include <cstdlib>  // for std::size_t
+#include <istream>
+#include <memory>  // for std::shared_ptr
 #include <ostream>
 #include <set>
 #include <string>
 #include <utility>  // for std::pair
 #include <vector>
 
+#include "bitboard.h"
 #include "cell.h"
+#include "layout.h"
+#include "trail.h"
 
 class Board {
  public:
@@ -44,9 +51,41 @@ class Board {
 
   Board();
   Board(const std::vector<std::vector<int>>& data);
+  // clues in row order, with 0 for blank cells
+  explicit Board(const std::array<int, 81>& clues);
+  Board(const Board& other);
+  Board& operator=(const Board& other);
 
   BoardValidationResult Validate() const;
 
+  // checks clues in row order, with 0 for blank cells, without building a
+  // board; the messages are the same as Validate's
+  static BoardValidationResult ValidateGrid(
+      const std::array<int, 81>& grid,
+      const Layout& layout = *Layout::Standard());
+
+  const Cell *cell(std::size_t row_num, std::size_t col_num) const;
+  Cell *cell(std::size_t row_num, std::size_t col_num);
+
+  // changes made through these are recorded in the attached trail, if any
+  void SetSolution(Cell *cell, int solution);
+  void SetGuesses(Cell *cell, const Cell::CellGuesses& guesses);
+  void RemoveGuess(Cell *cell, int guess);
+
+  // the unsolved cells that still have the digit as a guess, kept up to
+  // date by the mutators above
+  const Bitboard& candidates(int digit) const;
+
+  // the units the board's digits can't repeat in; the standard layout
+  // unless a variant was loaded with the puzzle
+  const Layout& layout() const;
+  const std::shared_ptr<const Layout>& shared_layout() const;
+  void set_layout(const std::shared_ptr<const Layout>& layout);
+
+  // a copy of the board starts without a trail
+  Trail *trail() const;
+  void set_trail(Trail *trail);
+
   std::vector<const Cell *> row(std::size_t row_num) const;
   std::vector<Cell *> row(std::size_t row_num);
 
@@ -56,40 +95,54 @@ class Board {
   std::vector<const Cell *> box(std::size_t box_num) const;
   std::vector<Cell *> box(std::size_t box_num);
 
+  // the cells of layout().units()[unit_index]
+  std::vector<const Cell *> unit(std::size_t unit_index) const;
+  std::vector<Cell *> unit(std::size_t unit_index);
+
   // board_tostring.cpp
   std::string ToString(
       const std::set<const Cell *>& cells_to_highlight = {}) const;
 
- private:
-  struct CellListValidationResult {
-    bool valid;
-    int duplicate_solution;
-
-    static CellListValidationResult Valid() {
-      return CellListValidationResult(true);
-    }
-
-    static CellListValidationResult Invalid(int duplicate_solution) {
-      return CellListValidationResult(false, duplicate_solution);
-    }
-
-   private:
-    CellListValidationResult(bool valid, int duplicate_solution = 0)
-        : valid(valid), duplicate_solution(duplicate_solution) {}
-  };
+  // board_snapshot.cc
+  // compact binary copy of every cell, guesses included
+  static const std::size_t kSnapshotRecordSize = 81 * 2;
+  static bool IsSnapshot(std::istream& is);
+  // the header holds the layout, which every board in the snapshot shares
+  static void WriteSnapshotHeader(std::ostream& os, const Layout& layout);
+  static std::shared_ptr<const Layout> ReadSnapshotHeader(std::istream& is);
+  void WriteSnapshot(std::ostream& os) const;
+  // returns false at the end of the stream
+  static bool ReadSnapshot(std::istream& is, Board *board);
+  // one cell's word in a record, for formats that store cells one by one
+  static std::uint16_t SnapshotWord(const Cell& cell);
+  void SetFromSnapshotWord(Cell *cell, std::uint16_t word);
+  // whether ReadSnapshot can read the record, without making a board
+  static bool ValidSnapshotRecord(const char *record);
 
-  CellListValidationResult ValidateCellList(
-      std::vector<const Cell *> cell_list) const;
+ private:
+  // Trail::Undo changes cells directly, then brings candidates_ back in line
+  friend class Trail;
 
-  void InitializeBoxLookup();
+  void InitializeCandidates();
+  void UpdateCandidates(const Cell *cell);
 
   // board_tostring.cpp
   static std::string CellToStringLine1(const Cell& cell);
   static std::string CellToStringLine2(const Cell& cell);
 
+  // board_snapshot.cc
+  static const char kSnapshotMagic[4];
+  static const char kSnapshotVersion = 2;
+  static const int kSnapshotSolutionShift = 12;
+
   BoardData data_;
 
-  std::vector<Cell *> box_lookup_;
+  std::shared_ptr<const Layout> layout_;
+
+  // indexed by digit; element 0 is never used
+  std::array<Bitboard, 10> candidates_;
+
+  Trail *trail_;
 };
 
 #endif
@@ -0,0 +1,135 @@
+#include <algorithm>  // for std::equal
+#include <cstdint>  // for std::uint16_t
+#include <istream>
+#include <stdexcept>  // for std::invalid_argument
+#include <string>
+
+#include "board.h"
+
+// A snapshot is the header, followed by one record per board. The header
+// is the magic and version, then the layout's "#!" lines as a 16-bit
+// little-endian length and the text; version 1 had no layout, and is read
+// as the standard one. A record is 81 little-endian 16-bit words in row
+// order: bits 1 to 9 are the guesses of an unsolved cell, and bits 12 to 15
+// are the solution of a solved one.
+
+const char Board::kSnapshotMagic[] = {'S', 'D', 'K', 'S'};
+
+bool Board::IsSnapshot(std::istream& is) {
+  auto start = is.tellg();
+  char magic[sizeof(kSnapshotMagic)];
+  bool result = is.read(magic, sizeof(magic)) &&
+                std::equal(magic, magic + sizeof(magic), kSnapshotMagic);
+
+  is.clear();
+  is.seekg(start);
+  return result;
+}
+
+void Board::WriteSnapshotHeader(std::ostream& os, const Layout& layout) {
+  std::string text = layout.ToText();
+  if (text.size() > 0xffff)
+    throw std::invalid_argument("Layout is too big for a board snapshot");
+
+  os.write(kSnapshotMagic, sizeof(kSnapshotMagic));
+  os.put(kSnapshotVersion);
+  os.put(static_cast<char>(text.size() & 0xff));
+  os.put(static_cast<char>(text.size() >> 8));
+  os.write(text.data(), text.size());
+}
+
+std::shared_ptr<const Layout> Board::ReadSnapshotHeader(std::istream& is) {
+  char header[sizeof(kSnapshotMagic) + 1];
+  if (!is.read(header, sizeof(header)) ||
+      !std::equal(kSnapshotMagic, kSnapshotMagic + sizeof(kSnapshotMagic),
+                  header))
+    throw std::invalid_argument("Not a board snapshot");
+
+  char version = header[sizeof(kSnapshotMagic)];
+  if (version == 1)
+    return Layout::Standard();
+  if (version != kSnapshotVersion)
+    throw std::invalid_argument("Unsupported board snapshot version");
+
+  unsigned char length[2];
+  if (!is.read(reinterpret_cast<char *>(length), sizeof(length)))
+    throw std::invalid_argument("Board snapshot is truncated");
+
+  std::string text(length[0] | (length[1] << 8), '\0');
+  if (!is.read(&text[0], text.size()))
+    throw std::invalid_argument("Board snapshot is truncated");
+
+  return Layout::FromText(text.data(), text.data() + text.size());
+}
+
+void Board::WriteSnapshot(std::ostream& os) const {
+  char record[kSnapshotRecordSize];
+  char *out = record;
+
+  for (const auto& row : data_) {
+    for (const Cell& cell : row) {
+      std::uint16_t word = SnapshotWord(cell);
+      *out++ = static_cast<char>(word & 0xff);
+      *out++ = static_cast<char>(word >> 8);
+    }
+  }
+
+  os.write(record, sizeof(record));
+}
+
+bool Board::ReadSnapshot(std::istream& is, Board *board) {
+  char record[kSnapshotRecordSize];
+  if (!is.read(record, sizeof(record))) {
+    if (is.gcount() == 0)
+      return false;
+    throw std::invalid_argument("Board snapshot is truncated");
+  }
+
+  const unsigned char *in = reinterpret_cast<unsigned char *>(record);
+  Board result;
+
+  for (std::size_t i = 1; i <= 9; ++i) {
+    for (std::size_t j = 1; j <= 9; ++j) {
+      std::uint16_t word = in[0] | (in[1] << 8);
+      in += 2;
+
+      result.SetFromSnapshotWord(result.cell(i, j), word);
+    }
+  }
+
+  *board = result;
+  return true;
+}
+
+std::uint16_t Board::SnapshotWord(const Cell& cell) {
+  return cell.solved()
+    ? static_cast<std::uint16_t>(cell.solution() << kSnapshotSolutionShift)
+    : cell.guesses().mask();
+}
+
+void Board::SetFromSnapshotWord(Cell *cell, std::uint16_t word) {
+  if (int solution = word >> kSnapshotSolutionShift; solution != 0) {
+    // throws if the solution is out of range
+    SetSolution(cell, solution);
+  } else if ((word & ~Cell::CellGuesses::kAll) != 0) {
+    throw std::invalid_argument("Cell " + cell->DescribeLocation() +
+                                " has invalid guesses in snapshot");
+  } else {
+    SetGuesses(cell, Cell::CellGuesses::FromMask(word));
+  }
+}
+
+bool Board::ValidSnapshotRecord(const char *record) {
+  const unsigned char *in = reinterpret_cast<const unsigned char *>(record);
+
+  // as SetFromSnapshotWord and Cell::set_solution check them
+  for (std::size_t i = 0; i < 81; ++i, in += 2) {
+    std::uint16_t word = in[0] | (in[1] << 8);
+    int solution = word >> kSnapshotSolutionShift;
+    if (solution > 9 ||
+        (solution == 0 && (word & ~Cell::CellGuesses::kAll) != 0))
+      return false;
+  }
+
+  return true;
+}
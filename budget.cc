@@ -0,0 +1,49 @@
+#include <limits>  // for std::numeric_limits
+
+#include "budget.h"
+
+Budget::Budget()
+    : has_deadline_(false),
+      max_steps_(std::numeric_limits<std::uint64_t>::max()),
+      max_nodes_(std::numeric_limits<std::uint64_t>::max()),
+      checks_until_clock_(0),
+      exhausted_(false) {}
+
+void Budget::set_deadline(Clock::time_point deadline) {
+  has_deadline_ = true;
+  deadline_ = deadline;
+  checks_until_clock_ = 0;
+}
+
+void Budget::set_timeout(Clock::duration timeout) {
+  set_deadline(Clock::now() + timeout);
+}
+
+void Budget::set_max_steps(std::uint64_t max_steps) {
+  max_steps_ = max_steps;
+}
+
+void Budget::set_max_nodes(std::uint64_t max_nodes) {
+  max_nodes_ = max_nodes;
+}
+
+bool Budget::Exhausted(std::uint64_t steps, std::uint64_t nodes) {
+  if (exhausted_)
+    return true;
+
+  if (steps >= max_steps_ || nodes >= max_nodes_) {
+    exhausted_ = true;
+    return true;
+  }
+
+  if (has_deadline_) {
+    if (checks_until_clock_ == 0) {
+      checks_until_clock_ = kClockInterval;
+      if (Clock::now() >= deadline_)
+        exhausted_ = true;
+    }
+    --checks_until_clock_;
+  }
+
+  return exhausted_;
+}
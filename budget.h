@@ -0,0 +1,39 @@
+#ifndef BUDGET_H_
+#define BUDGET_H_
+
+#include <chrono>
+#include <cstdint>  // for std::uint64_t
+
+// limits on how much work a single solve may do
+//
+// Counters are compared on every check, but the clock is only read every
+// kClockInterval checks, so a budget is cheap enough to leave on.
+class Budget {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  // no limits
+  Budget();
+
+  void set_deadline(Clock::time_point deadline);
+  void set_timeout(Clock::duration timeout);
+  void set_max_steps(std::uint64_t max_steps);
+  void set_max_nodes(std::uint64_t max_nodes);
+
+  // true once the deadline has passed or either count has reached its
+  // limit; stays true after that
+  bool Exhausted(std::uint64_t steps, std::uint64_t nodes);
+
+ private:
+  static const unsigned kClockInterval = 256;
+
+  bool has_deadline_;
+  Clock::time_point deadline_;
+  std::uint64_t max_steps_;
+  std::uint64_t max_nodes_;
+
+  unsigned checks_until_clock_;
+  bool exhausted_;
+};
+
+#endif
@@ -17,7 +17,7 @@ Cell::Cell(std::size_t row, std::size_t col, int solution) {
   }
 }
 
-Cell::Cell(std::size_t row, std::size_t col, const std::set<int>& guesses)
+Cell::Cell(std::size_t row, std::size_t col, const CellGuesses& guesses)
     : solution_(0), solved_(false) {
   set_location(row, col);
   set_guesses(guesses);
@@ -59,7 +59,6 @@ bool Cell::has_guess(int guess) const {
     throw std::logic_error("Cell solved");
 
   return guesses_.count(guess) == 1;
-  // C++20: return guesses_.contains(guess);
 }
 
 bool Cell::solved() const {
@@ -83,9 +82,9 @@ void Cell::set_guesses(const Cell::CellGuesses& guesses) {
       std::string error = std::to_string(guess) + " is an invalid guess";
       throw std::invalid_argument(error);
     }
-
-    guesses_ = guesses;
   }
+
+  guesses_ = guesses;
 }
 
 void Cell::add_guess(int guess) {
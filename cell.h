@@ -2,12 +2,13 @@
 #define CELL_H_
 
 #include <cstddef>  // for std::size_t
-#include <set>
 #include <string>
 
+#include "guesses.h"
+
 class Cell {
  public:
-  using CellGuesses = std::set<int>;
+  using CellGuesses = Guesses;
 
   Cell(std::size_t row, std::size_t col);
   Cell(std::size_t row, std::size_t col, int solution);
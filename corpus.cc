@@ -0,0 +1,99 @@
+#include <fstream>
+#include <stdexcept>  // for std::invalid_argument
+
+#include "corpus.h"
+#include "mapped_file.h"
+#include "puzzle_parser.h"
+
+void Corpus::ForEach(const std::string& filename,
+                     const std::function<bool(const Entry&)>& callback) {
+  ForEach(filename, {0, 1}, callback);
+}
+
+void Corpus::ForEach(const std::string& filename, const Start& start,
+                     const std::function<bool(const Entry&)>& callback) {
+  std::ifstream fs(filename, std::ifstream::in | std::ifstream::binary);
+
+  if (Board::IsSnapshot(fs)) {
+    auto layout = Board::ReadSnapshotHeader(fs);
+    if (start.offset > 0)
+      fs.seekg(start.offset);
+
+    Entry entry{start.position, true, Board(), ""};
+    while (Board::ReadSnapshot(fs, &entry.board)) {
+      entry.board.set_layout(layout);
+      if (!callback(entry))
+        return;
+      ++entry.position;
+    }
+    return;
+  }
+
+  fs.close();
+
+  MappedFile file(filename);
+  if (start.offset > file.size())
+    throw std::invalid_argument(filename + " is shorter than expected");
+
+  PuzzleParser parser(file.begin() + start.offset, file.end(),
+                      start.position);
+  PuzzleParser::Puzzle puzzle;
+
+  while (true) {
+    try {
+      if (!parser.Next(&puzzle))
+        return;
+    } catch (const PuzzleParser::ParseError& e) {
+      if (!callback({e.line(), false, Board(), e.what()}))
+        return;
+      continue;
+    }
+
+    if (!callback({parser.puzzle_line(), true, Board(puzzle), ""}))
+      return;
+  }
+}
+
+void Corpus::Scan(const std::string& filename,
+                  const std::function<void(const Start&)>& callback) {
+  std::ifstream fs(filename, std::ifstream::in | std::ifstream::binary);
+
+  if (Board::IsSnapshot(fs)) {
+    Board::ReadSnapshotHeader(fs);
+
+    Start start{static_cast<std::uint64_t>(fs.tellg()), 1};
+    char record[Board::kSnapshotRecordSize];
+    while (fs.read(record, sizeof(record))) {
+      callback(start);
+      // ForEach stops at a record it can't read
+      if (!Board::ValidSnapshotRecord(record))
+        return;
+      start.offset += sizeof(record);
+      ++start.position;
+    }
+
+    // and at a truncated one
+    if (fs.gcount() > 0)
+      callback(start);
+    return;
+  }
+
+  fs.close();
+
+  MappedFile file(filename);
+  PuzzleParser parser(file.begin(), file.end());
+  PuzzleParser::Puzzle puzzle;
+
+  while (true) {
+    Start start{static_cast<std::uint64_t>(parser.pos() - file.begin()),
+                parser.line()};
+    try {
+      if (!parser.Next(&puzzle))
+        return;
+    } catch (const PuzzleParser::ParseError&) {
+      // still counts, as ForEach passes it on
+    }
+
+    callback(start);
+  }
+}
@@ -0,0 +1,50 @@
+#ifndef CORPUS_H_
+#define CORPUS_H_
+
+#include <cstddef>  // for std::size_t
+#include <cstdint>  // for std::uint64_t
+#include <functional>
+#include <string>
+
+#include "board.h"
+
+// every puzzle in a file: clues in any layout PuzzleParser reads, or the
+// boards in a snapshot
+class Corpus {
+ public:
+  struct Entry {
+    // where the puzzle starts: a line for clues, a record for snapshots
+    std::size_t position;
+    bool valid;
+    Board board;
+    std::string error;
+  };
+
+  // where ForEach can start reading in the middle of a file
+  struct Start {
+    // bytes into the file
+    std::uint64_t offset;
+    // the position, as in Entry, of what's there
+    std::size_t position;
+  };
+
+  // calls callback for each puzzle in order, including ones that couldn't
+  // be read; stops early if callback returns false
+  static void ForEach(const std::string& filename,
+                      const std::function<bool(const Entry&)>& callback);
+
+  // the same, from a start found by Scan
+  static void ForEach(const std::string& filename, const Start& start,
+                      const std::function<bool(const Entry&)>& callback);
+
+  // calls callback with where each puzzle ForEach would find starts,
+  // including a snapshot record it would stop at, but without making any
+  // boards; throws if the file can't be read at all
+  static void Scan(const std::string& filename,
+                   const std::function<void(const Start&)>& callback);
+
+ private:
+  Corpus() {}  // prevent instantiating this class
+};
+
+#endif
@@ -0,0 +1,214 @@
+#include "enumerator.h"
+#include "parallel.h"
+
+Enumerator::Enumerator() : stopped_(false) {}
+
+Enumerator::Enumerator(const Options& options)
+    : options_(options), stopped_(false) {}
+
+void Enumerator::set_progress_callback(const ProgressCallback& callback) {
+  progress_callback_ = callback;
+}
+
+Enumerator::Stats Enumerator::Enumerate(const Board& board,
+                                        const SolutionCallback& callback) {
+  stats_ = Stats();
+  stopped_ = false;
+  callback_ = callback;
+  next_progress_ =
+    std::chrono::steady_clock::now() + options_.progress_interval;
+
+  layout_ = board.shared_layout();
+
+  State root;
+  root.used.assign(layout_->units().size(), 0);
+
+  for (std::size_t i = 0; i < 81; ++i) {
+    const Cell *cell = board.cell(i / 9 + 1, i % 9 + 1);
+    root.grid[i] = 0;
+    root.allowed[i] = Cell::CellGuesses::kAll;
+
+    if (cell->solved()) {
+      // a board with clashing clues has no solutions
+      if ((Candidates(root, i) >> cell->solution() & 1) == 0 ||
+          !Place(&root, i, cell->solution()))
+        return stats_;
+    } else if (!cell->guesses().empty()) {
+      root.allowed[i] = cell->guesses().mask();
+    }
+  }
+
+  if (options_.jobs <= 1) {
+    std::uint64_t nodes = 0;
+    Descend(&root, &nodes);
+    AddNodes(&nodes);
+  } else {
+    auto subtrees = Split(root, options_.jobs * kSubtreesPerJob);
+    ParallelFor(subtrees.size(), options_.jobs, [&](std::size_t i) {
+      std::uint64_t nodes = 0;
+      Descend(&subtrees[i], &nodes);
+      AddNodes(&nodes);
+    });
+  }
+
+  stats_.complete = !stopped_;
+  return stats_;
+}
+
+std::uint16_t Enumerator::Candidates(const State& state,
+                                     std::size_t index) const {
+  std::uint16_t used = 0;
+  for (std::size_t unit : layout_->units_of(index))
+    used |= state.used[unit];
+
+  return state.allowed[index] & ~used;
+}
+
+bool Enumerator::Place(State *state, std::size_t index, int digit) const {
+  const auto& units = layout_->units();
+
+  for (std::size_t unit : layout_->units_of(index)) {
+    if (units[unit].sum == 0)
+      continue;
+
+    int sum = digit;
+    bool filled = true;
+    for (std::size_t cell : units[unit].cells) {
+      sum += state->grid[cell];
+      filled = filled && (cell == index || state->grid[cell] != 0);
+    }
+
+    if (sum > units[unit].sum || (filled && sum != units[unit].sum))
+      return false;
+  }
+
+  std::uint16_t bit = 1 << digit;
+  state->grid[index] = digit;
+  for (std::size_t unit : layout_->units_of(index))
+    state->used[unit] |= bit;
+
+  return true;
+}
+
+void Enumerator::Unplace(State *state, std::size_t index, int digit) const {
+  std::uint16_t bit = 1 << digit;
+  state->grid[index] = 0;
+  for (std::size_t unit : layout_->units_of(index))
+    state->used[unit] &= ~bit;
+}
+
+std::size_t Enumerator::ChooseCell(const State& state) const {
+  std::size_t best = 81;
+  int best_count = 10;
+
+  for (std::size_t i = 0; i < 81; ++i) {
+    if (state.grid[i] != 0)
+      continue;
+
+    int count = __builtin_popcount(Candidates(state, i));
+    if (count < best_count) {
+      best = i;
+      best_count = count;
+      // nothing beats a dead end or a forced cell
+      if (count <= 1)
+        break;
+    }
+  }
+
+  return best;
+}
+
+std::vector<Enumerator::State> Enumerator::Split(const State& root,
+                                                 std::size_t count) {
+  std::vector<State> subtrees = {root};
+
+  while (subtrees.size() < count) {
+    std::vector<State> next;
+    bool split = false;
+
+    for (const State& state : subtrees) {
+      std::size_t index = ChooseCell(state);
+      if (index == 81) {
+        // already a solution
+        next.push_back(state);
+        continue;
+      }
+
+      split = true;
+      for (std::uint16_t candidates = Candidates(state, index);
+           candidates != 0; candidates &= candidates - 1) {
+        ++stats_.nodes;
+        State child = state;
+        if (Place(&child, index, __builtin_ctz(candidates)))
+          next.push_back(child);
+      }
+    }
+
+    subtrees.swap(next);
+    if (!split)
+      break;
+  }
+
+  return subtrees;
+}
+
+bool Enumerator::Descend(State *state, std::uint64_t *nodes) {
+  if (stopped_)
+    return false;
+
+  std::size_t index = ChooseCell(*state);
+  if (index == 81)
+    return Report(state->grid);
+
+  for (std::uint16_t candidates = Candidates(*state, index); candidates != 0;
+       candidates &= candidates - 1) {
+    if (++*nodes == kNodeBatch)
+      AddNodes(nodes);
+
+    int digit = __builtin_ctz(candidates);
+    if (!Place(state, index, digit))
+      continue;
+
+    bool keep_going = Descend(state, nodes);
+    Unplace(state, index, digit);
+
+    if (!keep_going)
+      return false;
+  }
+
+  return true;
+}
+
+bool Enumerator::Report(const Grid& grid) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (stopped_)
+    return false;
+
+  // only stop once there is one more than the limit, so that a board with
+  // exactly that many solutions still counts as complete
+  if (options_.limit > 0 && stats_.solutions == options_.limit) {
+    stopped_ = true;
+    return false;
+  }
+
+  ++stats_.solutions;
+  if (!callback_(grid))
+    stopped_ = true;
+
+  return !stopped_;
+}
+
+void Enumerator::AddNodes(std::uint64_t *nodes) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  stats_.nodes += *nodes;
+  *nodes = 0;
+
+  if (!progress_callback_ || options_.progress_interval.count() == 0)
+    return;
+
+  auto now = std::chrono::steady_clock::now();
+  if (now >= next_progress_) {
+    progress_callback_(stats_);
+    next_progress_ = now + options_.progress_interval;
+  }
+}
@@ -0,0 +1,101 @@
+#ifndef ENUMERATOR_H_
+#define ENUMERATOR_H_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>  // for std::size_t
+#include <cstdint>  // for std::uint16_t, std::uint64_t
+#include <functional>
+#include <memory>  // for std::shared_ptr
+#include <mutex>
+#include <vector>
+
+#include "board.h"
+
+// every solution of a board, handed out one at a time as they're found
+//
+// This is a plain depth-first search over a bitmask per unit of the board's
+// layout, without the reasoning Search does, since all of the tree has to
+// be visited anyway. Nothing is kept once a solution has been handed out,
+// so memory use doesn't depend on how many solutions there are.
+class Enumerator {
+ public:
+  // digits in row order
+  using Grid = std::array<int, 81>;
+
+  struct Options {
+    // stop after this many solutions; zero means no limit
+    std::uint64_t limit = 0;
+
+    // with more than one job, the tree is split into subtrees that are
+    // searched in parallel, and solutions come out in no particular order
+    unsigned jobs = 1;
+
+    // how often the progress callback is called; zero means never
+    std::chrono::milliseconds progress_interval{0};
+  };
+
+  struct Stats {
+    std::uint64_t solutions = 0;
+    std::uint64_t nodes = 0;
+    // false if the limit or the callback stopped the search early
+    bool complete = true;
+  };
+
+  // called for each solution, by one thread at a time; return false to stop
+  using SolutionCallback = std::function<bool(const Grid&)>;
+  using ProgressCallback = std::function<void(const Stats&)>;
+
+  Enumerator();
+  explicit Enumerator(const Options& options);
+
+  void set_progress_callback(const ProgressCallback& callback);
+
+  // the board's guesses, where it has any, limit the digits tried in each
+  // cell
+  Stats Enumerate(const Board& board, const SolutionCallback& callback);
+
+ private:
+  // enough to give every job several subtrees, so that they finish at
+  // about the same time
+  static const std::size_t kSubtreesPerJob = 16;
+  // nodes a thread counts on its own before adding them to the total
+  static const std::uint64_t kNodeBatch = 4096;
+
+  struct State {
+    Grid grid;
+    // digits each empty cell may still hold, as in Guesses::mask
+    std::array<std::uint16_t, 81> allowed;
+    // the digits used so far in each unit of the layout
+    std::vector<std::uint16_t> used;
+  };
+
+  std::uint16_t Candidates(const State& state, std::size_t index) const;
+  // returns false, placing nothing, if the digit would break a cage's sum
+  bool Place(State *state, std::size_t index, int digit) const;
+  void Unplace(State *state, std::size_t index, int digit) const;
+
+  // the empty cell with the fewest candidates, or 81 if there are none
+  std::size_t ChooseCell(const State& state) const;
+
+  // splits the tree into at least count subtrees, unless it's too small
+  std::vector<State> Split(const State& root, std::size_t count);
+
+  // returns false once the search should stop
+  bool Descend(State *state, std::uint64_t *nodes);
+  bool Report(const Grid& grid);
+  void AddNodes(std::uint64_t *nodes);
+
+  Options options_;
+  std::shared_ptr<const Layout> layout_;
+  ProgressCallback progress_callback_;
+  SolutionCallback callback_;
+
+  std::mutex mutex_;
+  Stats stats_;
+  std::atomic<bool> stopped_;
+  std::chrono::steady_clock::time_point next_progress_;
+};
+
+#endif
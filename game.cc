@@ -1,60 +1,222 @@
 #include <fstream>
-#include <sstream>
-#include <vector>
+#include <iterator>  // for std::istreambuf_iterator
 
+#include "enumerator.h"
 #include "game.h"
+#include "puzzle_parser.h"
+
+Game::Game(const std::string& board_filename)
+    : trace_(nullptr), searched_(false) {
+  std::ifstream fs(board_filename, std::ifstream::in | std::ifstream::binary);
+
+  // resume from a snapshot, guesses and all
+  if (Board::IsSnapshot(fs)) {
+    auto layout = Board::ReadSnapshotHeader(fs);
+    if (!Board::ReadSnapshot(fs, &board_))
+      throw std::invalid_argument("Board snapshot is empty");
+    board_.set_layout(layout);
+    InitializeClues();
+    return;
+  }
+
+  std::string text{std::istreambuf_iterator<char>(fs),
+                   std::istreambuf_iterator<char>()};
+  PuzzleParser parser(text.data(), text.data() + text.size());
+
+  PuzzleParser::Puzzle puzzle;
+  if (!parser.Next(&puzzle))
+    throw std::invalid_argument("Board must have 9 rows");
+
+  board_ = Board(puzzle);
 
-Game::Game(const std::string& board_filename) {
-  std::ifstream fs(board_filename, std::ifstream::in);
+  // variants are named on "#!" lines, which the parser skipped
+  board_.set_layout(Layout::FromText(text.data(), text.data() + text.size()));
+  InitializeClues();
+}
 
-  std::vector<std::vector<int>> board_from_file;
+Game::Game(const Board& board)
+    : board_(board), trace_(nullptr), searched_(false) {
+  InitializeClues();
+}
 
-  std::string line;
-  while (std::getline(fs, line)) {
-    std::istringstream ss(line);
-    std::vector<int> row;
+void Game::SaveSnapshot(const std::string& snapshot_filename) const {
+  std::ofstream fs(snapshot_filename,
+                   std::ofstream::out | std::ofstream::binary);
+  Board::WriteSnapshotHeader(fs, board_.layout());
+  board_.WriteSnapshot(fs);
 
-    std::string word;
-    while (ss >> word) {
-      int cell = std::stoi(word);
+  if (!fs)
+    throw std::runtime_error("Couldn't write " + snapshot_filename);
+}
 
-      if (cell < 0 || cell > 9)
-        throw std::invalid_argument("Cell must be between 0 and 9");
+Game::BoardValidationResult Game::ValidateBoard() const {
+  return board_.Validate();
+}
 
-      row.push_back(cell);
+Game::StepResult Game::Step() {
+  const auto& techniques = Operators::Techniques();
+
+  for (std::size_t i = 0; i < techniques.size(); ++i) {
+    if (auto result = techniques[i].apply(board_); result.changed()) {
+      if (trace_)
+        trace_->Record(i, board_, result.cells_changed);
+      return StepResult::Step(i, result);
     }
+  }
+
+  return StepResult::Done();
+}
+
+Game::SolveResult Game::Solve() {
+  Budget budget = budget_;
+  SolveCounters counters;
+  counters.technique_counts.resize(Operators::Techniques().size());
 
-    if (row.size() != 9)
-      throw std::invalid_argument("Row must have 9 cells");
+  if (auto result = ValidateBoard(); !result.valid)
+    return SolveResult::Invalid(board_, result.validation_message);
 
-    board_from_file.push_back(row);
+  try {
+    while (true) {
+      if (budget.Exhausted(counters.steps, 0))
+        return SolveResult::OutOfBudget(board_, counters);
+
+      auto result = Step();
+      if (result.done)
+        break;
+
+      ++counters.steps;
+      ++counters.technique_counts[result.technique];
+    }
+  } catch (const std::logic_error&) {
+    // a cell ran out of possible guesses
+    return SolveResult::Unsolvable(board_, counters);
   }
 
-  if (board_from_file.size() != 9)
-    throw std::invalid_argument("Board must have 9 rows");
+  if (auto result = ValidateBoard(); result.solved)
+    return SolveResult::Solved(board_, counters);
+  else if (!result.valid)
+    return SolveResult::Unsolvable(board_, counters);
+
+  Search search;
+  search.set_budget(&budget);
+  auto result = search.Solve(board_);
+  counters.search_stats = result.stats;
+
+  if (result.solved) {
+    board_ = result.board;
+    searched_ = true;
+    if (trace_)
+      trace_->RecordSearch(board_);
+    return SolveResult::Solved(board_, counters);
+  }
 
-  board_ = Board(board_from_file);
-}
+  if (result.cancelled)
+    return SolveResult::OutOfBudget(board_, counters);
 
-Game::BoardValidationResult Game::ValidateBoard() const {
-  return board_.Validate();
+  return SolveResult::Unsolvable(board_, counters);
 }
 
-Game::StepResult Game::Step() {
-  if (auto result = Operators::FillInGuesses(board_); result.changed())
-    return StepResult::Step(result);
+Game::EditResult Game::SetClue(std::size_t row_num, std::size_t col_num,
+                               int digit) {
+  if (digit < 0 || digit > 9)
+    throw std::invalid_argument(std::to_string(digit) +
+                                " is an invalid clue");
+
+  Cell *cell = board_.cell(row_num, col_num);
+  std::size_t index = (row_num - 1) * 9 + (col_num - 1);
+  int previous = clues_[index];
+  clues_[index] = digit;
+
+  // a new clue the deductions so far don't rule out
+  bool narrows = previous == 0 && digit != 0 && !searched_ &&
+                 (cell->solved() ? cell->solution() == digit
+                                 : cell->guesses().empty() ||
+                                   cell->has_guess(digit));
+
+  if (!narrows) {
+    Board board(clues_);
+    board.set_layout(board_.shared_layout());
+    board_ = board;
+    searched_ = false;
+  } else if (!cell->solved()) {
+    board_.SetSolution(cell, digit);
+
+    // only the new clue's peers can lose a guess, as TrimGuesses would do
+    bool stuck = false;
+    for (std::size_t peer_index : board_.layout().peers(index)) {
+      Cell *peer = board_.cell(peer_index / 9 + 1, peer_index % 9 + 1);
+      if (!peer->solved() && peer->has_guess(digit)) {
+        board_.RemoveGuess(peer, digit);
+        stuck = stuck || peer->guesses().empty();
+      }
+    }
+
+    if (stuck)
+      return {EditResult::Status::kNoSolution, 0};
+  }
 
-  if (auto result = Operators::SingleGuessRule(board_); result.changed())
-    return StepResult::Step(result);
+  EditResult result{EditResult::Status::kNoSolution, 0};
+  if (!ValidateBoard().valid)
+    return result;
 
-  if (auto result = Operators::HiddenSingleGuessRule(board_);
-      result.changed()) {
-    return StepResult::Step(result);
+  try {
+    while (!Step().done)
+      ++result.steps;
+  } catch (const std::logic_error&) {
+    // a cell ran out of possible guesses
+    return result;
   }
 
-  return StepResult::Done();
+  if (auto validation = ValidateBoard(); validation.solved) {
+    // the operators only rule out what can't be, so there's no other
+    // solution
+    result.status = EditResult::Status::kUnique;
+    return result;
+  } else if (!validation.valid) {
+    return result;
+  }
+
+  // the guesses the operators left are all the Enumerator has to try
+  Enumerator::Options options;
+  options.limit = 1;
+  auto stats = Enumerator(options).Enumerate(
+      board_, [](const Enumerator::Grid&) { return true; });
+
+  if (stats.solutions == 0)
+    result.status = EditResult::Status::kNoSolution;
+  else if (stats.complete)
+    result.status = EditResult::Status::kUnique;
+  else
+    result.status = EditResult::Status::kMultipleSolutions;
+
+  return result;
+}
+
+Hints::Hint Game::HintForCell(std::size_t row_num,
+                              std::size_t col_num) const {
+  return Hints::ForCell(board_, row_num, col_num);
+}
+
+Hints::Hint Game::HintForUnit(Hints::UnitType type,
+                              std::size_t number) const {
+  return Hints::ForUnit(board_, type, number);
 }
 
 const Board& Game::board() const {
   return board_;
 }
+
+void Game::set_budget(const Budget& budget) {
+  budget_ = budget;
+}
+
+void Game::set_trace(SolveTrace::Writer *trace) {
+  trace_ = trace;
+}
+
+void Game::InitializeClues() {
+  for (std::size_t i = 0; i < 81; ++i) {
+    const Cell *cell = board_.cell(i / 9 + 1, i % 9 + 1);
+    clues_[i] = cell->solved() ? cell->solution() : 0;
+  }
+}
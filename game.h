@@ -1,12 +1,20 @@
 #ifndef GAME_H_
 #define GAME_H_
 
+#include <array>
+#include <cstddef>  // for std::size_t
+#include <cstdint>  // for std::uint64_t
 #include <set>
-#include <stdexcept>  // for std::invalid_argument
+#include <stdexcept>  // for std::invalid_argument, std::runtime_error
 #include <string>
+#include <vector>
 
 #include "board.h"
+#include "budget.h"
+#include "hints.h"
 #include "operators.h"
+#include "search.h"
+#include "solve_trace.h"
 
 class Game {
  public:
@@ -23,35 +31,131 @@ class Game {
 
   struct StepResult {
     bool done;
+    // index into Operators::Techniques() of the operator that made the step
+    std::size_t technique;
     std::set<const Cell *> cells_changed;
     std::vector<std::string> change_descriptions;
 
     static StepResult Step(
+        std::size_t technique,
         const Operators::OperationResult& operation_result) {
-      return StepResult(false, operation_result.cells_changed,
-                             operation_result.change_descriptions);
+      return StepResult(false, technique, operation_result.cells_changed,
+                        operation_result.change_descriptions);
     }
 
-    static StepResult Done() { return StepResult(true); }
+    static StepResult Done() { return StepResult(true, 0); }
 
    private:
-    StepResult(bool done,
+    StepResult(bool done, std::size_t technique,
                std::set<const Cell *> cells_changed = {},
                const std::vector<std::string>& change_descriptions = {})
-        : done(done), cells_changed(cells_changed),
+        : done(done), technique(technique), cells_changed(cells_changed),
           change_descriptions(change_descriptions) {}
   };
 
+  // how much work a solve did
+  struct SolveCounters {
+    std::uint64_t steps = 0;
+    // indexed like Operators::Techniques()
+    std::vector<std::uint64_t> technique_counts;
+    Search::Stats search_stats;
+  };
+
+  struct SolveResult {
+    enum class Status { kSolved, kUnsolvable, kInvalid, kOutOfBudget };
+
+    Status status;
+    // the solution, or as far as the operators got before stopping
+    Board board;
+    SolveCounters counters;
+    std::string message;
+
+    static SolveResult Solved(const Board& board,
+                              const SolveCounters& counters) {
+      return SolveResult(Status::kSolved, board, counters);
+    }
+
+    static SolveResult Unsolvable(const Board& board,
+                                  const SolveCounters& counters) {
+      return SolveResult(Status::kUnsolvable, board, counters);
+    }
+
+    static SolveResult Invalid(const Board& board,
+                               const std::string& message) {
+      return SolveResult(Status::kInvalid, board, {}, message);
+    }
+
+    static SolveResult OutOfBudget(const Board& board,
+                                   const SolveCounters& counters) {
+      return SolveResult(Status::kOutOfBudget, board, counters);
+    }
+
+   private:
+    SolveResult(Status status, const Board& board,
+                const SolveCounters& counters,
+                const std::string& message = "")
+        : status(status), board(board), counters(counters),
+          message(message) {}
+  };
+
+  // whether the clues still have one solution after an edit
+  struct EditResult {
+    enum class Status { kUnique, kNoSolution, kMultipleSolutions };
+
+    Status status;
+    // steps the operators took to bring the board up to date
+    std::uint64_t steps;
+  };
+
   // Game();
+  // the file can hold clues or a snapshot saved by SaveSnapshot
   Game(const std::string& board_filename);
+  explicit Game(const Board& board);
+
+  // save the board, guesses included, so the game can be resumed later
+  void SaveSnapshot(const std::string& snapshot_filename) const;
 
   BoardValidationResult ValidateBoard() const;
   StepResult Step();
 
+  // step until the operators are done, then search if that wasn't enough;
+  // stops early if the budget runs out
+  SolveResult Solve();
+
+  // sets the clue in the cell, or removes it if the digit is 0, and steps
+  // until the operators are done; the solved cells the game started with
+  // are its clues
+  //
+  // Adding a clue only narrows the puzzle, so everything worked out so far
+  // still holds and the operators carry on from the board as it is.
+  // Changing or removing one can undo any deduction made since, so then the
+  // board starts again from the clues.
+  EditResult SetClue(std::size_t row_num, std::size_t col_num, int digit);
+
+  // the next deduction for one cell or unit, without changing the board
+  Hints::Hint HintForCell(std::size_t row_num, std::size_t col_num) const;
+  Hints::Hint HintForUnit(Hints::UnitType type, std::size_t number) const;
+
   const Board& board() const;
 
+  // limits for each call to Solve; a deadline is shared by all of them
+  void set_budget(const Budget& budget);
+
+  // every step from now on, including a search's, is recorded in the
+  // trace, if any; a copy of the game records to the same trace
+  void set_trace(SolveTrace::Writer *trace);
+
  private:
+  void InitializeClues();
+
   Board board_;
+  Budget budget_;
+  SolveTrace::Writer *trace_;
+  // in row order, with 0 for blank cells
+  std::array<int, 81> clues_;
+  // the board holds a solution Search found, which might not be the only
+  // one, rather than just what the operators worked out
+  bool searched_;
 };
 
 #endif
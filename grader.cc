@@ -0,0 +1,42 @@
+#include "grader.h"
+#include "operators.h"
+
+Grader::Grade Grader::GradeSolve(const Game::SolveResult& result) {
+  if (result.status != Game::SolveResult::Status::kSolved)
+    return Grade::Ungraded();
+
+  const auto& techniques = Operators::Techniques();
+  const auto& counts = result.counters.technique_counts;
+
+  std::string hardest_technique = "None";
+  int hardest_difficulty = 0;
+  double weighted_uses = 0;
+
+  for (std::size_t i = 0; i < techniques.size() && i < counts.size(); ++i) {
+    if (counts[i] == 0)
+      continue;
+
+    weighted_uses += static_cast<double>(techniques[i].difficulty) * counts[i];
+    if (techniques[i].difficulty > hardest_difficulty) {
+      hardest_technique = techniques[i].name;
+      hardest_difficulty = techniques[i].difficulty;
+    }
+  }
+
+  if (auto nodes = result.counters.search_stats.nodes; nodes > 0) {
+    weighted_uses += static_cast<double>(kSearchDifficulty) * nodes;
+    hardest_technique = "Trial and error";
+    hardest_difficulty = kSearchDifficulty;
+  }
+
+  const double kHalfWeight = 1000;
+  double score = hardest_difficulty +
+                 weighted_uses / (weighted_uses + kHalfWeight);
+
+  return Grade::Graded(hardest_technique, hardest_difficulty, score);
+}
+
+Grader::Grade Grader::GradeBoard(const Board& board) {
+  Game game{board};
+  return GradeSolve(game.Solve());
+}
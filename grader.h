@@ -0,0 +1,47 @@
+#ifndef GRADER_H_
+#define GRADER_H_
+
+#include <string>
+
+#include "board.h"
+#include "game.h"
+
+// grades boards by the hardest technique Game::Step needed to solve them
+class Grader {
+ public:
+  struct Grade {
+    bool graded;
+    std::string hardest_technique;
+    int hardest_difficulty;
+    // the whole part is the hardest difficulty; the fraction grows towards
+    // one with the number and difficulty of all the deductions made
+    double score;
+
+    static Grade Graded(const std::string& hardest_technique,
+                        int hardest_difficulty, double score) {
+      return Grade(true, hardest_technique, hardest_difficulty, score);
+    }
+
+    // the board wasn't solved, so there's nothing to grade
+    static Grade Ungraded() { return Grade(false, "", 0, 0); }
+
+   private:
+    Grade(bool graded, const std::string& hardest_technique,
+          int hardest_difficulty, double score)
+        : graded(graded), hardest_technique(hardest_technique),
+          hardest_difficulty(hardest_difficulty), score(score) {}
+  };
+
+  // boards the operators can't finish need trial and error
+  static const int kSearchDifficulty = 100;
+
+  // Game::Solve already counts the techniques it used, so grading a solve
+  // costs nothing extra
+  static Grade GradeSolve(const Game::SolveResult& result);
+  static Grade GradeBoard(const Board& board);
+
+ private:
+  Grader() {}  // prevent instantiating this class
+};
+
+#endif
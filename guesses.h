@@ -0,0 +1,89 @@
+#ifndef GUESSES_H_
+#define GUESSES_H_
+
+#include <cstddef>  // for std::size_t, std::ptrdiff_t
+#include <cstdint>  // for std::uint16_t
+#include <initializer_list>
+#include <iterator>  // for std::forward_iterator_tag
+
+// set of the digits 1 to 9, stored as a bitmask so that cells stay small
+// and cheap to copy and restore
+//
+// Bit n is set if n is in the set; bit 0 is never used.
+class Guesses {
+ public:
+  class const_iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = int;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const int *;
+    using reference = int;
+
+    const_iterator(std::uint16_t remaining) : remaining_(remaining) {}
+
+    int operator*() const { return __builtin_ctz(remaining_); }
+
+    const_iterator& operator++() {
+      remaining_ &= remaining_ - 1;
+      return *this;
+    }
+
+    const_iterator operator++(int) {
+      const_iterator previous = *this;
+      ++*this;
+      return previous;
+    }
+
+    bool operator==(const const_iterator& other) const {
+      return remaining_ == other.remaining_;
+    }
+
+    bool operator!=(const const_iterator& other) const {
+      return remaining_ != other.remaining_;
+    }
+
+   private:
+    std::uint16_t remaining_;
+  };
+
+  using iterator = const_iterator;
+
+  static constexpr std::uint16_t kAll = 0x3fe;
+
+  Guesses() : mask_(0) {}
+
+  Guesses(std::initializer_list<int> guesses) : mask_(0) {
+    for (int guess : guesses)
+      insert(guess);
+  }
+
+  static Guesses FromMask(std::uint16_t mask) {
+    Guesses result;
+    result.mask_ = mask & kAll;
+    return result;
+  }
+
+  std::uint16_t mask() const { return mask_; }
+
+  std::size_t size() const { return __builtin_popcount(mask_); }
+  bool empty() const { return mask_ == 0; }
+  std::size_t count(int guess) const { return (mask_ >> guess) & 1; }
+
+  void insert(int guess) { mask_ |= 1 << guess; }
+  void erase(int guess) { mask_ &= ~(1 << guess); }
+  void clear() { mask_ = 0; }
+
+  const_iterator begin() const { return const_iterator(mask_); }
+  const_iterator end() const { return const_iterator(0); }
+  const_iterator cbegin() const { return begin(); }
+  const_iterator cend() const { return end(); }
+
+  bool operator==(const Guesses& other) const { return mask_ == other.mask_; }
+  bool operator!=(const Guesses& other) const { return mask_ != other.mask_; }
+
+ private:
+  std::uint16_t mask_;
+};
+
+#endif
@@ -0,0 +1,204 @@
+#include <cstdint>  // for std::uint16_t
+#include <sstream>
+#include <stdexcept>  // for std::invalid_argument
+
+#include "hints.h"
+
+Hints::Hint Hints::ForCell(const Board& board, std::size_t row_num,
+                           std::size_t col_num) {
+  const Cell *cell = board.cell(row_num, col_num);
+
+  if (cell->solved())
+    return Hint::None("Cell " + cell->DescribeLocation() +
+                      " is already solved");
+
+  if (auto hint = SingleGuessHint(board, cell); hint.found())
+    return hint;
+
+  // a digit the cell can hold can't go anywhere else in the unit only if
+  // this cell is the one place for it; a small cage needn't have every
+  // digit, so only complete units count
+  auto possible = PossibleGuesses(board, cell);
+  for (const Unit& unit : UnitsOf(board, cell)) {
+    if (!unit.complete())
+      continue;
+
+    for (int digit : possible) {
+      if (auto hint = HiddenSingleHint(board, unit, digit); hint.found())
+        return hint;
+    }
+  }
+
+  if (auto hint = EliminationHint(board, cell); hint.found())
+    return hint;
+
+  return Hint::None("Nothing to do in cell " + cell->DescribeLocation() +
+                    " yet");
+}
+
+Hints::Hint Hints::ForUnit(const Board& board, UnitType type,
+                           std::size_t number) {
+  Unit unit = GetUnit(board, type, number);
+
+  for (const Cell *cell : unit.cell_list) {
+    if (cell->solved())
+      continue;
+
+    if (auto hint = SingleGuessHint(board, cell); hint.found())
+      return hint;
+  }
+
+  for (int digit = 1; digit <= 9; ++digit) {
+    if (auto hint = HiddenSingleHint(board, unit, digit); hint.found())
+      return hint;
+  }
+
+  for (const Cell *cell : unit.cell_list) {
+    if (cell->solved())
+      continue;
+
+    if (auto hint = EliminationHint(board, cell); hint.found())
+      return hint;
+  }
+
+  return Hint::None("Nothing to do in " + UnitName(type) + " " +
+                    std::to_string(number) + " yet");
+}
+
+std::string Hints::UnitName(UnitType type) {
+  switch (type) {
+    case UnitType::kRow:
+      return "row";
+    case UnitType::kColumn:
+      return "column";
+    case UnitType::kBox:
+      return "box";
+  }
+
+  return "";
+}
+
+// the rows, columns, and boxes come first in every layout
+Hints::Unit Hints::GetUnit(const Board& board, UnitType type,
+                           std::size_t number) {
+  if (number < 1 || number > 9)
+    throw std::invalid_argument("Invalid " + UnitName(type) + " number");
+
+  switch (type) {
+    case UnitType::kRow:
+      return GetLayoutUnit(board, number - 1);
+    case UnitType::kColumn:
+      return GetLayoutUnit(board, 9 + number - 1);
+    case UnitType::kBox:
+      return GetLayoutUnit(board, 18 + number - 1);
+  }
+
+  return {UnitName(type), number, {}};
+}
+
+Hints::Unit Hints::GetLayoutUnit(const Board& board, std::size_t unit_index) {
+  const Layout::Unit& unit = board.layout().units()[unit_index];
+  return {Layout::KindName(unit.kind), unit.number, board.unit(unit_index)};
+}
+
+std::vector<Hints::Unit> Hints::UnitsOf(const Board& board,
+                                        const Cell *cell) {
+  std::size_t index = (cell->row() - 1) * 9 + (cell->col() - 1);
+
+  std::vector<Unit> units;
+  for (std::size_t unit_index : board.layout().units_of(index))
+    units.push_back(GetLayoutUnit(board, unit_index));
+
+  return units;
+}
+
+Cell::CellGuesses Hints::SolvedIn(const Unit& unit) {
+  Cell::CellGuesses solved;
+  for (const Cell *cell : unit.cell_list) {
+    if (cell->solved())
+      solved.insert(cell->solution());
+  }
+
+  return solved;
+}
+
+// the digits not already solved in any unit of the cell, narrowed down by
+// the cell's guesses once those have been filled in
+Cell::CellGuesses Hints::PossibleGuesses(const Board& board,
+                                         const Cell *cell) {
+  std::uint16_t possible = cell->guesses().empty() ? Cell::CellGuesses::kAll
+                                                   : cell->guesses().mask();
+
+  // read the peers in place; this runs for every cell a hint looks at
+  std::size_t index = (cell->row() - 1) * 9 + (cell->col() - 1);
+  for (std::size_t peer : board.layout().peers(index)) {
+    const Cell *peer_cell = board.cell(peer / 9 + 1, peer % 9 + 1);
+    if (peer_cell->solved())
+      possible &= ~(1 << peer_cell->solution());
+  }
+
+  return Cell::CellGuesses::FromMask(possible);
+}
+
+Hints::Hint Hints::SingleGuessHint(const Board& board, const Cell *cell) {
+  auto possible = PossibleGuesses(board, cell);
+
+  if (possible.empty())
+    return Hint::Contradiction(cell, "Cell " + cell->DescribeLocation() +
+                                     " has no possible guesses");
+
+  if (possible.size() != 1)
+    return Hint::None("");
+
+  int digit = *possible.cbegin();
+  std::ostringstream description;
+  description << "Cell " << cell->DescribeLocation() << " can only be "
+              << digit;
+  return Hint::Solve(cell, digit, description.str());
+}
+
+Hints::Hint Hints::HiddenSingleHint(const Board& board, const Unit& unit,
+                                    int digit) {
+  if (SolvedIn(unit).count(digit) == 1)
+    return Hint::None("");
+
+  std::vector<const Cell *> cells_with_this_guess;
+  for (const Cell *cell : unit.cell_list) {
+    if (!cell->solved() && PossibleGuesses(board, cell).count(digit) == 1)
+      cells_with_this_guess.push_back(cell);
+  }
+
+  std::ostringstream description;
+
+  if (cells_with_this_guess.empty()) {
+    description << "There is nowhere left for a " << digit << " in "
+                << unit.kind_name << " " << unit.number;
+    return Hint::Contradiction(nullptr, description.str());
+  }
+
+  if (cells_with_this_guess.size() != 1)
+    return Hint::None("");
+
+  const Cell *cell = cells_with_this_guess[0];
+  description << "Cell " << cell->DescribeLocation() << " has the only "
+              << digit << " in its " << unit.kind_name;
+  return Hint::Solve(cell, digit, description.str());
+}
+
+// a guess already solved elsewhere in one of the cell's units
+Hints::Hint Hints::EliminationHint(const Board& board, const Cell *cell) {
+  for (const Unit& unit : UnitsOf(board, cell)) {
+    auto solved = SolvedIn(unit);
+    for (int guess : cell->guesses()) {
+      if (solved.count(guess) == 1) {
+        std::ostringstream description;
+        description << guess << " can be removed from cell "
+                    << cell->DescribeLocation() << " because its "
+                    << unit.kind_name << " already has a " << guess;
+        return Hint::Eliminate(cell, guess, description.str());
+      }
+    }
+  }
+
+  return Hint::None("");
+}
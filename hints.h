@@ -0,0 +1,89 @@
+#ifndef HINTS_H_
+#define HINTS_H_
+
+#include <cstddef>  // for std::size_t
+#include <set>
+#include <string>
+#include <vector>
+
+#include "board.h"
+
+// the next deduction for one cell or unit, found by looking only at that
+// cell or unit and its peers, without changing the board
+class Hints {
+ public:
+  enum class UnitType { kRow, kColumn, kBox };
+
+  struct Hint {
+    enum class Kind { kNone, kSolve, kEliminate, kContradiction };
+
+    Kind kind;
+    const Cell *cell;
+    int digit;
+    std::set<const Cell *> cells_to_highlight;
+    std::string description;
+
+    bool found() const { return kind != Kind::kNone; }
+
+    static Hint Solve(const Cell *cell, int digit,
+                      const std::string& description) {
+      return Hint(Kind::kSolve, cell, digit, description);
+    }
+
+    static Hint Eliminate(const Cell *cell, int digit,
+                          const std::string& description) {
+      return Hint(Kind::kEliminate, cell, digit, description);
+    }
+
+    static Hint Contradiction(const Cell *cell,
+                              const std::string& description) {
+      return Hint(Kind::kContradiction, cell, 0, description);
+    }
+
+    static Hint None(const std::string& description) {
+      return Hint(Kind::kNone, nullptr, 0, description);
+    }
+
+   private:
+    Hint(Kind kind, const Cell *cell, int digit,
+         const std::string& description)
+        : kind(kind), cell(cell), digit(digit), description(description) {
+      if (cell)
+        cells_to_highlight.insert(cell);
+    }
+  };
+
+  static Hint ForCell(const Board& board, std::size_t row_num,
+                      std::size_t col_num);
+  static Hint ForUnit(const Board& board, UnitType type, std::size_t number);
+
+  static std::string UnitName(UnitType type);
+
+ private:
+  struct Unit {
+    // as in Layout::KindName
+    std::string kind_name;
+    std::size_t number;
+    std::vector<const Cell *> cell_list;
+
+    // holds every digit exactly once, as in Layout::Unit
+    bool complete() const { return cell_list.size() == 9; }
+  };
+
+  Hints() {}  // prevent instantiating this class
+
+  static Unit GetUnit(const Board& board, UnitType type, std::size_t number);
+  static Unit GetLayoutUnit(const Board& board, std::size_t unit_index);
+  static std::vector<Unit> UnitsOf(const Board& board, const Cell *cell);
+
+  static Cell::CellGuesses SolvedIn(const Unit& unit);
+  static Cell::CellGuesses PossibleGuesses(const Board& board,
+                                           const Cell *cell);
+
+  static Hint SingleGuessHint(const Board& board, const Cell *cell);
+  static Hint HiddenSingleHint(const Board& board, const Unit& unit,
+                               int digit);
+  static Hint EliminationHint(const Board& board, const Cell *cell);
+};
+
+#endif
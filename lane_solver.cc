@@ -0,0 +1,149 @@
+#include <stdexcept>  // for std::invalid_argument
+
+#include "lane_solver.h"
+
+std::vector<LaneSolver::Result> LaneSolver::Solve(
+    const std::vector<const Board *>& boards) {
+  if (boards.size() > kLanes)
+    throw std::invalid_argument("Too many boards for one lane solve");
+
+  // lane by lane, then turned around into one vector per cell; unused
+  // lanes have every candidate, so they never change
+  std::array<std::array<std::uint16_t, kLanes>, 81> masks;
+  for (auto& cell_masks : masks)
+    cell_masks.fill(Cell::CellGuesses::kAll);
+
+  for (std::size_t lane = 0; lane < boards.size(); ++lane) {
+    for (std::size_t i = 0; i < 81; ++i) {
+      const Cell *cell = boards[lane]->cell(i / 9 + 1, i % 9 + 1);
+      if (cell->solved())
+        masks[i][lane] = static_cast<std::uint16_t>(1 << cell->solution());
+      else if (!cell->guesses().empty())
+        masks[i][lane] = cell->guesses().mask();
+    }
+  }
+
+  Candidates candidates;
+  for (std::size_t i = 0; i < 81; ++i)
+    candidates[i] = LaneVector::Load(masks[i].data());
+
+  std::array<std::uint64_t, kLanes> rounds{};
+  LaneVector stuck;
+
+  while (true) {
+    Candidates previous = candidates;
+    stuck |= EliminateSingles(&candidates);
+    stuck |= SolveHiddenSingles(&candidates);
+
+    LaneVector changed;
+    for (std::size_t i = 0; i < 81; ++i) {
+      changed |= candidates[i] ^ previous[i];
+      stuck |= candidates[i].IsZero();
+    }
+
+    if (!changed.any())
+      break;
+
+    std::uint16_t lanes_changed[kLanes];
+    changed.Store(lanes_changed);
+    for (std::size_t lane = 0; lane < kLanes; ++lane)
+      rounds[lane] += lanes_changed[lane] != 0;
+  }
+
+  // a lane is solved when nothing got stuck and every cell is down to one
+  // candidate
+  LaneVector unsolved = stuck;
+  for (std::size_t i = 0; i < 81; ++i) {
+    const LaneVector& cell = candidates[i];
+    unsolved |= LaneVector::Fill(0xffff).AndNot((cell & cell.Decrement())
+                                                  .IsZero());
+    candidates[i].Store(masks[i].data());
+  }
+
+  std::uint16_t lanes_unsolved[kLanes];
+  unsolved.Store(lanes_unsolved);
+
+  std::vector<Result> results(boards.size());
+  for (std::size_t lane = 0; lane < boards.size(); ++lane) {
+    Result& result = results[lane];
+    result.solved = lanes_unsolved[lane] == 0;
+    result.rounds = rounds[lane];
+    for (std::size_t i = 0; i < 81; ++i) {
+      result.solution[i] =
+        result.solved ? __builtin_ctz(masks[i][lane]) : 0;
+    }
+  }
+
+  return results;
+}
+
+LaneVector LaneSolver::EliminateSingles(Candidates *candidates) {
+  // each cell's candidates if it has just one, or nothing
+  Candidates singles;
+  for (std::size_t i = 0; i < 81; ++i) {
+    const LaneVector& cell = (*candidates)[i];
+    singles[i] = cell & (cell & cell.Decrement()).IsZero();
+  }
+
+  const auto& units = Units();
+  std::array<LaneVector, 27> solved;
+  LaneVector twice;
+
+  for (std::size_t u = 0; u < units.size(); ++u) {
+    LaneVector once;
+    for (std::size_t i : units[u]) {
+      twice |= once & singles[i];
+      once |= singles[i];
+    }
+    solved[u] = once;
+  }
+
+  for (std::size_t i = 0; i < 81; ++i) {
+    std::size_t box = i / 27 * 3 + i % 9 / 3;
+    LaneVector taken = solved[i / 9] | solved[9 + i % 9] | solved[18 + box];
+    // a single keeps its own digit, which is among those taken
+    (*candidates)[i] = singles[i] | (*candidates)[i].AndNot(taken);
+  }
+
+  return LaneVector::Fill(0xffff).AndNot(twice.IsZero());
+}
+
+LaneVector LaneSolver::SolveHiddenSingles(Candidates *candidates) {
+  const LaneVector all = LaneVector::Fill(Cell::CellGuesses::kAll);
+  LaneVector missing;
+
+  for (const auto& unit : Units()) {
+    LaneVector once, twice;
+    for (std::size_t i : unit) {
+      twice |= once & (*candidates)[i];
+      once |= (*candidates)[i];
+    }
+
+    missing |= all.AndNot(once);
+    LaneVector only = once.AndNot(twice);
+    if (!only.any())
+      continue;
+
+    for (std::size_t i : unit) {
+      LaneVector& cell = (*candidates)[i];
+      LaneVector hidden = cell & only;
+      cell = hidden | (cell & hidden.IsZero());
+    }
+  }
+
+  return LaneVector::Fill(0xffff).AndNot(missing.IsZero());
+}
+
+const std::array<std::array<std::size_t, 9>, 27>& LaneSolver::Units() {
+  static const std::array<std::array<std::size_t, 9>, 27> units = []() {
+    std::array<std::array<std::size_t, 9>, 27> result;
+    const auto& layout_units = Layout::Standard()->units();
+    for (std::size_t u = 0; u < result.size(); ++u) {
+      for (std::size_t j = 0; j < 9; ++j)
+        result[u][j] = layout_units[u].cells[j];
+    }
+    return result;
+  }();
+
+  return units;
+}
@@ -0,0 +1,55 @@
+#ifndef LANE_SOLVER_H_
+#define LANE_SOLVER_H_
+
+#include <array>
+#include <cstddef>  // for std::size_t
+#include <cstdint>  // for std::uint64_t
+#include <vector>
+
+#include "board.h"
+#include "lane_vector.h"
+
+// solves up to sixteen puzzles at once, in lockstep, with singles and
+// hidden singles only
+//
+// The candidates are stored by cell, with one lane per puzzle, so every
+// step of the rules works on all the puzzles with the same instructions
+// and no branches that depend on any one of them. That's enough for most
+// easy and medium puzzles. The rest stall, or run into a contradiction,
+// and are left for Game to finish or to explain.
+class LaneSolver {
+ public:
+  static constexpr std::size_t kLanes = LaneVector::kLanes;
+
+  struct Result {
+    // false if the puzzle needs Game
+    bool solved;
+    // digits in row order, when solved
+    std::array<int, 81> solution;
+    // rounds of the rules that changed the puzzle
+    std::uint64_t rounds;
+  };
+
+  // at most kLanes boards, all with the standard layout; their guesses,
+  // where they have any, limit each cell's candidates
+  static std::vector<Result> Solve(const std::vector<const Board *>& boards);
+
+ private:
+  LaneSolver() {}  // prevent instantiating this class
+
+  using Candidates = std::array<LaneVector, 81>;
+
+  // takes each unit's solved digits out of the rest of its cells, and
+  // returns the lanes where a unit holds a digit twice
+  static LaneVector EliminateSingles(Candidates *candidates);
+
+  // solves the only cell in a unit that can hold a digit, and returns the
+  // lanes where a unit has nowhere left for one
+  static LaneVector SolveHiddenSingles(Candidates *candidates);
+
+  // the cells of the rows, columns, and boxes, in that order, as in the
+  // standard layout
+  static const std::array<std::array<std::size_t, 9>, 27>& Units();
+};
+
+#endif
@@ -0,0 +1,161 @@
+#ifndef LANE_VECTOR_H_
+#define LANE_VECTOR_H_
+
+#include <cstddef>  // for std::size_t
+#include <cstdint>  // for std::uint16_t
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#else
+#include <array>
+#endif
+
+// sixteen 16-bit lanes that are worked on together, one puzzle per lane
+//
+// With AVX2 this is one 256-bit register and each operation is a single
+// instruction. Otherwise it's a plain array, and the loops are simple
+// enough for the compiler to vectorize with whatever it has.
+class LaneVector {
+ public:
+  static constexpr std::size_t kLanes = 16;
+
+  LaneVector& operator&=(const LaneVector& other) {
+    return *this = *this & other;
+  }
+
+  LaneVector& operator|=(const LaneVector& other) {
+    return *this = *this | other;
+  }
+
+#if defined(__AVX2__)
+  LaneVector() : value_(_mm256_setzero_si256()) {}
+
+  static LaneVector Fill(std::uint16_t value) {
+    return LaneVector(_mm256_set1_epi16(static_cast<short>(value)));
+  }
+
+  // kLanes values
+  static LaneVector Load(const std::uint16_t *values) {
+    return LaneVector(_mm256_loadu_si256(
+        reinterpret_cast<const __m256i *>(values)));
+  }
+
+  void Store(std::uint16_t *values) const {
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(values), value_);
+  }
+
+  LaneVector operator&(const LaneVector& other) const {
+    return LaneVector(_mm256_and_si256(value_, other.value_));
+  }
+
+  LaneVector operator|(const LaneVector& other) const {
+    return LaneVector(_mm256_or_si256(value_, other.value_));
+  }
+
+  LaneVector operator^(const LaneVector& other) const {
+    return LaneVector(_mm256_xor_si256(value_, other.value_));
+  }
+
+  // this & ~other
+  LaneVector AndNot(const LaneVector& other) const {
+    return LaneVector(_mm256_andnot_si256(other.value_, value_));
+  }
+
+  // each lane less one, wrapping around at zero
+  LaneVector Decrement() const {
+    return LaneVector(_mm256_sub_epi16(value_, _mm256_set1_epi16(1)));
+  }
+
+  // all ones in the lanes that are zero, and zero in the others
+  LaneVector IsZero() const {
+    return LaneVector(_mm256_cmpeq_epi16(value_, _mm256_setzero_si256()));
+  }
+
+  bool any() const {
+    return !_mm256_testz_si256(value_, value_);
+  }
+
+ private:
+  explicit LaneVector(__m256i value) : value_(value) {}
+
+  __m256i value_;
+#else
+  LaneVector() : value_() {}
+
+  static LaneVector Fill(std::uint16_t value) {
+    LaneVector result;
+    result.value_.fill(value);
+    return result;
+  }
+
+  // kLanes values
+  static LaneVector Load(const std::uint16_t *values) {
+    LaneVector result;
+    for (std::size_t i = 0; i < kLanes; ++i)
+      result.value_[i] = values[i];
+    return result;
+  }
+
+  void Store(std::uint16_t *values) const {
+    for (std::size_t i = 0; i < kLanes; ++i)
+      values[i] = value_[i];
+  }
+
+  LaneVector operator&(const LaneVector& other) const {
+    LaneVector result;
+    for (std::size_t i = 0; i < kLanes; ++i)
+      result.value_[i] = value_[i] & other.value_[i];
+    return result;
+  }
+
+  LaneVector operator|(const LaneVector& other) const {
+    LaneVector result;
+    for (std::size_t i = 0; i < kLanes; ++i)
+      result.value_[i] = value_[i] | other.value_[i];
+    return result;
+  }
+
+  LaneVector operator^(const LaneVector& other) const {
+    LaneVector result;
+    for (std::size_t i = 0; i < kLanes; ++i)
+      result.value_[i] = value_[i] ^ other.value_[i];
+    return result;
+  }
+
+  // this & ~other
+  LaneVector AndNot(const LaneVector& other) const {
+    LaneVector result;
+    for (std::size_t i = 0; i < kLanes; ++i)
+      result.value_[i] = value_[i] & ~other.value_[i];
+    return result;
+  }
+
+  // each lane less one, wrapping around at zero
+  LaneVector Decrement() const {
+    LaneVector result;
+    for (std::size_t i = 0; i < kLanes; ++i)
+      result.value_[i] = static_cast<std::uint16_t>(value_[i] - 1);
+    return result;
+  }
+
+  // all ones in the lanes that are zero, and zero in the others
+  LaneVector IsZero() const {
+    LaneVector result;
+    for (std::size_t i = 0; i < kLanes; ++i)
+      result.value_[i] = value_[i] == 0 ? 0xffff : 0;
+    return result;
+  }
+
+  bool any() const {
+    std::uint16_t result = 0;
+    for (std::size_t i = 0; i < kLanes; ++i)
+      result |= value_[i];
+    return result != 0;
+  }
+
+ private:
+  std::array<std::uint16_t, kLanes> value_;
+#endif
+};
+
+#endif
@@ -0,0 +1,228 @@
+#include <algorithm>  // for std::find, std::sort
+#include <sstream>
+#include <stdexcept>  // for std::invalid_argument
+
+#include "layout.h"
+
+std::string Layout::Unit::Name() const {
+  std::string name = KindName(kind);
+  name[0] = static_cast<char>(name[0] - 'a' + 'A');
+  return name + " " + std::to_string(number);
+}
+
+Layout::Layout() {
+  for (std::size_t i = 0; i < 9; ++i) {
+    std::vector<std::size_t> cells;
+    for (std::size_t j = 0; j < 9; ++j)
+      cells.push_back(i * 9 + j);
+    AddUnit(UnitKind::kRow, cells, 0);
+  }
+
+  for (std::size_t i = 0; i < 9; ++i) {
+    std::vector<std::size_t> cells;
+    for (std::size_t j = 0; j < 9; ++j)
+      cells.push_back(j * 9 + i);
+    AddUnit(UnitKind::kColumn, cells, 0);
+  }
+
+  for (std::size_t i = 0; i < 9; ++i) {
+    std::size_t corner = i / 3 * 27 + i % 3 * 3;
+    std::vector<std::size_t> cells;
+    for (std::size_t j = 0; j < 9; ++j)
+      cells.push_back(corner + j / 3 * 9 + j % 3);
+    AddUnit(UnitKind::kBox, cells, 0);
+  }
+}
+
+std::shared_ptr<const Layout> Layout::Standard() {
+  static const std::shared_ptr<const Layout> standard =
+    std::make_shared<const Layout>();
+  return standard;
+}
+
+std::shared_ptr<const Layout> Layout::FromText(const char *begin,
+                                               const char *end) {
+  std::shared_ptr<Layout> layout;
+
+  std::size_t line_number = 0;
+  for (const char *pos = begin; pos < end;) {
+    const char *line_end = std::find(pos, end, '\n');
+    const char *line_begin = pos;
+    pos = line_end + (line_end < end ? 1 : 0);
+    ++line_number;
+
+    if (line_end - line_begin < 2 || line_begin[0] != '#' ||
+        line_begin[1] != '!')
+      continue;
+
+    std::string line(line_begin, line_end);
+
+    if (!layout)
+      layout = std::make_shared<Layout>();
+
+    std::istringstream ss(line.substr(2));
+    std::string variant;
+    ss >> variant;
+
+    auto fail = [&](const std::string& message) {
+      throw std::invalid_argument("Line " + std::to_string(line_number) +
+                                  ": " + message);
+    };
+
+    if (variant == "diagonal") {
+      layout->AddDiagonals();
+    } else if (variant == "windoku") {
+      layout->AddWindows();
+    } else if (variant == "cage") {
+      int sum = 0;
+      if (!(ss >> sum))
+        fail("Cage must start with its sum");
+
+      std::vector<std::size_t> cells;
+      std::string name;
+      while (ss >> name) {
+        if (name.size() != 2 || name[0] < 'A' || name[0] > 'I' ||
+            name[1] < 'a' || name[1] > 'i')
+          fail("Cell must be like Ab, not " + name);
+        cells.push_back((name[0] - 'A') * 9 + (name[1] - 'a'));
+      }
+
+      try {
+        layout->AddCage(sum, cells);
+      } catch (const std::invalid_argument& e) {
+        fail(e.what());
+      }
+    } else {
+      fail("Unknown variant " + variant);
+    }
+  }
+
+  if (!layout)
+    return Standard();
+
+  return layout;
+}
+
+std::string Layout::ToText() const {
+  std::string text;
+
+  // the rows, columns, and boxes come first, and every layout has them
+  for (std::size_t i = 27; i < units_.size(); ++i) {
+    const Unit& unit = units_[i];
+    if (unit.kind == UnitKind::kDiagonal && unit.number % 2 == 1) {
+      text += "#! diagonal\n";
+    } else if (unit.kind == UnitKind::kWindow && unit.number % 4 == 1) {
+      text += "#! windoku\n";
+    } else if (unit.kind == UnitKind::kCage) {
+      text += "#! cage " + std::to_string(unit.sum);
+      for (std::size_t cell : unit.cells) {
+        text += ' ';
+        text += static_cast<char>('A' + cell / 9);
+        text += static_cast<char>('a' + cell % 9);
+      }
+      text += '\n';
+    }
+  }
+
+  return text;
+}
+
+void Layout::AddDiagonals() {
+  std::vector<std::size_t> down, up;
+  for (std::size_t i = 0; i < 9; ++i) {
+    down.push_back(i * 9 + i);
+    up.push_back(i * 9 + (8 - i));
+  }
+
+  AddUnit(UnitKind::kDiagonal, down, 0);
+  AddUnit(UnitKind::kDiagonal, up, 0);
+}
+
+// the 3x3 windows with their top corners at Bb, Bf, Fb, and Ff
+void Layout::AddWindows() {
+  for (std::size_t corner : {10, 14, 46, 50}) {
+    std::vector<std::size_t> cells;
+    for (std::size_t j = 0; j < 9; ++j)
+      cells.push_back(corner + j / 3 * 9 + j % 3);
+    AddUnit(UnitKind::kWindow, cells, 0);
+  }
+}
+
+void Layout::AddCage(int sum, const std::vector<std::size_t>& cells) {
+  if (cells.empty() || cells.size() > 9)
+    throw std::invalid_argument("Cage must have 1 to 9 cells");
+
+  std::vector<std::size_t> sorted = cells;
+  std::sort(sorted.begin(), sorted.end());
+  if (std::adjacent_find(sorted.begin(), sorted.end()) != sorted.end())
+    throw std::invalid_argument("Cage can't have the same cell twice");
+
+  // the smallest and largest sums of that many different digits
+  int size = static_cast<int>(cells.size());
+  int min_sum = size * (size + 1) / 2;
+  int max_sum = size * (19 - size) / 2;
+  if (sum < min_sum || sum > max_sum)
+    throw std::invalid_argument("Cage of " + std::to_string(size) +
+                                " cells can't add up to " +
+                                std::to_string(sum));
+
+  AddUnit(UnitKind::kCage, cells, sum);
+}
+
+bool Layout::standard() const {
+  return units_.size() == 27;
+}
+
+const std::vector<Layout::Unit>& Layout::units() const {
+  return units_;
+}
+
+const std::vector<std::size_t>& Layout::units_of(std::size_t cell) const {
+  return units_of_[cell];
+}
+
+const std::vector<std::size_t>& Layout::peers(std::size_t cell) const {
+  return peers_[cell];
+}
+
+std::string Layout::KindName(UnitKind kind) {
+  switch (kind) {
+    case UnitKind::kRow:
+      return "row";
+    case UnitKind::kColumn:
+      return "column";
+    case UnitKind::kBox:
+      return "box";
+    case UnitKind::kDiagonal:
+      return "diagonal";
+    case UnitKind::kWindow:
+      return "window";
+    case UnitKind::kCage:
+      return "cage";
+  }
+
+  return "";
+}
+
+void Layout::AddUnit(UnitKind kind, const std::vector<std::size_t>& cells,
+                     int sum) {
+  std::size_t number = 1;
+  for (const Unit& unit : units_) {
+    if (unit.kind == kind)
+      ++number;
+  }
+
+  std::size_t index = units_.size();
+  units_.push_back({kind, number, cells, sum});
+
+  for (std::size_t cell : cells) {
+    units_of_[cell].push_back(index);
+
+    auto& peers = peers_[cell];
+    for (std::size_t peer : cells) {
+      if (peer != cell &&
+          std::find(peers.cbegin(), peers.cend(), peer) == peers.cend())
+        peers.push_back(peer);
+    }
+  }
+}
@@ -0,0 +1,83 @@
+#ifndef LAYOUT_H_
+#define LAYOUT_H_
+
+#include <array>
+#include <cstddef>  // for std::size_t
+#include <memory>  // for std::shared_ptr
+#include <string>
+#include <vector>
+
+// the units of a puzzle: groups of cells that can't repeat a digit
+//
+// Every layout has the rows, columns, and boxes, in that order. Variants
+// add units on top of them: the two long diagonals, the four windoku
+// windows, and killer cages, whose digits must also add up to a sum. The
+// units each cell belongs to, and its peers, are worked out once when a
+// unit is added, so the operators can walk them without any special cases.
+//
+// Cells are numbered 0 to 80 in row order.
+class Layout {
+ public:
+  enum class UnitKind { kRow, kColumn, kBox, kDiagonal, kWindow, kCage };
+
+  struct Unit {
+    UnitKind kind;
+    // counting from 1 among the units of the same kind
+    std::size_t number;
+    std::vector<std::size_t> cells;
+    // for cages, what the digits add up to; zero otherwise
+    int sum;
+
+    // holds every digit exactly once
+    bool complete() const { return cells.size() == 9; }
+
+    // like "Row 3" or "Cage 12"
+    std::string Name() const;
+  };
+
+  // rows, columns, and boxes only
+  Layout();
+
+  // shared by every board that doesn't use a variant
+  static std::shared_ptr<const Layout> Standard();
+
+  // the standard layout plus any variants named on lines starting with
+  // "#!" in a puzzle file, which PuzzleParser skips as comments:
+  //
+  //   #! diagonal
+  //   #! windoku
+  //   #! cage 15 Aa Ab Ba
+  //
+  // Cells are named as in Cell::DescribeLocation.
+  static std::shared_ptr<const Layout> FromText(const char *begin,
+                                                const char *end);
+
+  // "#!" lines that FromText reads back as this layout; empty for the
+  // standard one
+  std::string ToText() const;
+
+  void AddDiagonals();
+  void AddWindows();
+  void AddCage(int sum, const std::vector<std::size_t>& cells);
+
+  // only rows, columns, and boxes
+  bool standard() const;
+
+  const std::vector<Unit>& units() const;
+  // indexes into units() of the units holding the cell
+  const std::vector<std::size_t>& units_of(std::size_t cell) const;
+  // the other cells that share a unit with the cell
+  const std::vector<std::size_t>& peers(std::size_t cell) const;
+
+  static std::string KindName(UnitKind kind);
+
+ private:
+  void AddUnit(UnitKind kind, const std::vector<std::size_t>& cells,
+               int sum);
+
+  std::vector<Unit> units_;
+  std::array<std::vector<std::size_t>, 81> units_of_;
+  std::array<std::vector<std::size_t>, 81> peers_;
+};
+
+#endif
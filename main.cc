@@ -1,8 +1,36 @@
+#include <algorithm>  // for std::min
+#include <chrono>
+#include <cstdint>  // for std::uint64_t
+#include <fstream>
+#include <iomanip>  // for std::setprecision
 #include <iostream>
 #include <limits>  // for std::numeric_limits
 #include <sstream>
+#include <stdexcept>  // for std::invalid_argument
+#include <string>
+#include <vector>
 
+#include "corpus.h"
+#include "enumerator.h"
 #include "game.h"
+#include "grader.h"
+#include "lane_solver.h"
+#include "mapped_file.h"
+#include "minimizer.h"
+#include "parallel.h"
+#include "puzzle_parser.h"
+#include "search.h"
+#include "shard_runner.h"
+#include "solve_trace.h"
+#include "step_pipeline.h"
+
+const int kSuccess = 0;
+const int kUnableToSolve = 1;
+const int kInvalidBoard = 2;
+const int kNoBoard = 3;
+
+// how many steps the interactive mode works out before they're shown
+const std::size_t kStepsAhead = 8;
 
 void output_board(const Board& board,
                   std::set<const Cell *> cells_changed,
@@ -14,19 +42,1005 @@ void output_board(const Board& board,
   std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
 }
 
-int main(int argc, char const *argv[]) {
-  const int kSuccess = 0;
-  const int kUnableToSolve = 1;
-  const int kInvalidBoard = 2;
-  const int kNoBoard = 3;
+void output_search_stats(const std::string& name,
+                         const Search::Stats& stats) {
+  std::cout << name << ": " << stats.nodes << " nodes, "
+            << stats.backtracks << " backtracks, "
+            << stats.backjumps << " backjumps, "
+            << stats.nogoods_learned << " nogoods learned, "
+            << stats.nogoods_forgotten << " forgotten, "
+            << stats.nogood_prunes << " prunes, "
+            << "depth " << stats.max_depth << '\n';
+}
+
+// solve with plain backtracking and with nogood learning, and compare
+int search(const std::string& board_filename) {
+  Game game = Game(board_filename);
+
+  if (auto result = game.ValidateBoard(); !result.valid) {
+    std::cout << result.validation_message << "\n";
+    return kInvalidBoard;
+  }
+
+  Search plain_search(Search::Options::Plain());
+  auto plain = plain_search.Solve(game.board());
+
+  Search learning_search;
+  auto learning = learning_search.Solve(game.board());
+
+  std::cout << learning.board.ToString() << '\n';
+  output_search_stats("Plain backtracking", plain.stats);
+  output_search_stats("Nogood learning", learning.stats);
+
+  if (plain.stats.nodes > 0) {
+    double reduction = 100.0 * (1.0 - static_cast<double>(
+        learning.stats.nodes) / plain.stats.nodes);
+    std::cout << "Node reduction: " << reduction << "%\n";
+  }
+
+  return learning.solved ? kSuccess : kUnableToSolve;
+}
+
+struct BatchOptions {
+  // zero means no limit
+  std::uint64_t timeout_ms = 0;
+  std::uint64_t max_steps = 0;
+  std::uint64_t max_nodes = 0;
+
+  bool grade = false;
+  unsigned jobs = 1;
+  // try singles on many puzzles at once before handing them to Game; the
+  // step counts are then rounds, and grading and --max-steps need Game's,
+  // so they turn this off
+  bool lanes = false;
+
+  // only the puzzles numbered first to first + count - 1, counting from
+  // zero across all the files; workers of a sharded batch get one range
+  std::uint64_t first = 0;
+  std::uint64_t count = std::numeric_limits<std::uint64_t>::max();
+
+  // set for a worker of a sharded batch, which starts reading at puzzle
+  // first rather than at the beginning, and writes its totals for
+  // sharded_batch to add up rather than for people
+  bool shard = false;
+  ShardRunner::Start start{0, 0, 1};
+
+  // each puzzle gets a fresh budget, so the deadline starts now
+  Budget MakeBudget() const {
+    Budget budget;
+    if (timeout_ms > 0)
+      budget.set_timeout(std::chrono::milliseconds(timeout_ms));
+    if (max_steps > 0)
+      budget.set_max_steps(max_steps);
+    if (max_nodes > 0)
+      budget.set_max_nodes(max_nodes);
+    return budget;
+  }
+};
+
+struct BatchEntry {
+  std::string label;
+  Corpus::Entry puzzle;
+  Game::SolveResult result;
+  Grader::Grade grade;
+};
+
+struct BatchTotals {
+  std::uint64_t puzzles = 0;
+  std::uint64_t solved = 0;
+  std::uint64_t unsolvable = 0;
+  std::uint64_t out_of_budget = 0;
+  std::uint64_t invalid = 0;
+  std::vector<std::uint64_t> technique_counts =
+    std::vector<std::uint64_t>(Operators::Techniques().size());
+  std::uint64_t search_nodes = 0;
+};
+
+void solve_batch_entry(BatchEntry *entry, const BatchOptions& options) {
+  if (!entry->puzzle.valid) {
+    entry->result = Game::SolveResult::Invalid(Board(), entry->puzzle.error);
+    return;
+  }
+
+  Game game{entry->puzzle.board};
+  game.set_budget(options.MakeBudget());
+  entry->result = game.Solve();
+
+  if (options.grade)
+    entry->grade = Grader::GradeSolve(entry->result);
+}
+
+// the puzzles LaneSolver finishes before their deadlines are done; the
+// rest go to Game as usual, which decides whether they're out of budget
+void solve_batch_lanes(BatchEntry *entries, std::size_t count,
+                       const BatchOptions& options) {
+  std::vector<BatchEntry *> lane_entries;
+  std::vector<const Board *> boards;
+  std::vector<Budget> budgets;
+
+  for (std::size_t i = 0; i < count; ++i) {
+    const Corpus::Entry& puzzle = entries[i].puzzle;
+    if (puzzle.valid && puzzle.board.layout().standard()) {
+      lane_entries.push_back(&entries[i]);
+      boards.push_back(&puzzle.board);
+      budgets.push_back(options.MakeBudget());
+    } else {
+      solve_batch_entry(&entries[i], options);
+    }
+  }
+
+  auto results = LaneSolver::Solve(boards);
+
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    // only the deadline applies, as there are no step limits with lanes
+    if (!results[i].solved || budgets[i].Exhausted(0, 0)) {
+      solve_batch_entry(lane_entries[i], options);
+      continue;
+    }
+
+    Game::SolveCounters counters;
+    counters.steps = results[i].rounds;
+    counters.technique_counts.resize(Operators::Techniques().size());
+    lane_entries[i]->result =
+      Game::SolveResult::Solved(Board(results[i].solution), counters);
+  }
+}
+
+void output_batch_entry(const BatchEntry& entry, BatchTotals *totals) {
+  const auto& result = entry.result;
+  std::cout << entry.label << ": ";
+  ++totals->puzzles;
+
+  switch (result.status) {
+    case Game::SolveResult::Status::kSolved:
+      ++totals->solved;
+      std::cout << "solved";
+      break;
+    case Game::SolveResult::Status::kUnsolvable:
+      ++totals->unsolvable;
+      std::cout << "unsolvable";
+      break;
+    case Game::SolveResult::Status::kOutOfBudget:
+      ++totals->out_of_budget;
+      std::cout << "out of budget";
+      break;
+    case Game::SolveResult::Status::kInvalid:
+      ++totals->invalid;
+      std::cout << "invalid: " << result.message << '\n';
+      return;
+  }
+
+  const auto& counters = result.counters;
+  for (std::size_t j = 0; j < counters.technique_counts.size(); ++j)
+    totals->technique_counts[j] += counters.technique_counts[j];
+  totals->search_nodes += counters.search_stats.nodes;
+
+  std::cout << " (" << counters.steps << " steps, "
+            << counters.search_stats.nodes << " nodes)";
+
+  if (entry.grade.graded) {
+    std::cout << ", grade " << std::fixed << std::setprecision(2)
+              << entry.grade.score << std::defaultfloat << " ("
+              << entry.grade.hardest_technique << ')';
+  }
+
+  std::cout << '\n';
+}
+
+void output_batch_totals(const BatchTotals& totals,
+                         const BatchOptions& options) {
+  std::cout << "Solved: " << totals.solved
+            << ", unsolvable: " << totals.unsolvable
+            << ", out of budget: " << totals.out_of_budget
+            << ", invalid: " << totals.invalid << '\n';
+
+  if (options.grade) {
+    const auto& techniques = Operators::Techniques();
+    for (std::size_t i = 0; i < techniques.size(); ++i) {
+      if (techniques[i].difficulty > 0)
+        std::cout << techniques[i].name << ": "
+                  << totals.technique_counts[i] << '\n';
+    }
+    std::cout << "Trial and error: " << totals.search_nodes << " nodes\n";
+  }
+}
+
+// the first word of the line output_shard_totals writes
+const char kShardTotals[] = "totals";
+
+// totals on one line of numbers, for add_shard_totals to read back
+void output_shard_totals(const BatchTotals& totals) {
+  std::cout << kShardTotals << ' ' << totals.puzzles << ' ' << totals.solved
+            << ' ' << totals.unsolvable << ' ' << totals.out_of_budget
+            << ' ' << totals.invalid << ' ' << totals.search_nodes;
+  for (std::uint64_t count : totals.technique_counts)
+    std::cout << ' ' << count;
+  std::cout << '\n';
+}
+
+// adds totals written by output_shard_totals to totals; false if the line
+// isn't one of them
+bool add_shard_totals(const std::string& line, BatchTotals *totals) {
+  std::istringstream ss(line);
+  std::string kind;
+  BatchTotals shard;
+
+  ss >> kind >> shard.puzzles >> shard.solved >> shard.unsolvable
+     >> shard.out_of_budget >> shard.invalid >> shard.search_nodes;
+  for (std::uint64_t& count : shard.technique_counts)
+    ss >> count;
+
+  if (!ss || kind != kShardTotals || !(ss >> std::ws).eof())
+    return false;
+
+  totals->puzzles += shard.puzzles;
+  totals->solved += shard.solved;
+  totals->unsolvable += shard.unsolvable;
+  totals->out_of_budget += shard.out_of_budget;
+  totals->invalid += shard.invalid;
+  totals->search_nodes += shard.search_nodes;
+  for (std::size_t i = 0; i < shard.technique_counts.size(); ++i)
+    totals->technique_counts[i] += shard.technique_counts[i];
+
+  return true;
+}
+
+// solve every puzzle in the files without stopping, and count the outcomes
+//
+// Puzzles are read and solved a block at a time, so memory use doesn't
+// depend on the size of the files.
+int batch(const std::vector<std::string>& board_filenames,
+          const BatchOptions& options) {
+  const std::size_t kBlockSize = 4096;
+
+  BatchTotals totals;
+  std::vector<BatchEntry> block;
+
+  auto flush = [&]() {
+    if (options.lanes && !options.grade && options.max_steps == 0) {
+      std::size_t groups =
+        (block.size() + LaneSolver::kLanes - 1) / LaneSolver::kLanes;
+      ParallelFor(groups, options.jobs, [&](std::size_t i) {
+        std::size_t first = i * LaneSolver::kLanes;
+        solve_batch_lanes(&block[first],
+                          std::min(LaneSolver::kLanes, block.size() - first),
+                          options);
+      });
+    } else {
+      ParallelFor(block.size(), options.jobs, [&](std::size_t i) {
+        solve_batch_entry(&block[i], options);
+      });
+    }
+
+    for (const BatchEntry& entry : block)
+      output_batch_entry(entry, &totals);
+
+    block.clear();
+  };
+
+  // a shard starts at its first puzzle, in the middle of a file
+  std::uint64_t number = options.shard ? options.first : 0;
+  auto in_range = [&](std::uint64_t n) {
+    return n >= options.first && n - options.first < options.count;
+  };
+
+  for (std::size_t i = 0; i < board_filenames.size(); ++i) {
+    const std::string& board_filename = board_filenames[i];
+    if (number >= options.first && !in_range(number))
+      break;
+
+    if (options.shard && i < options.start.file)
+      continue;
+
+    Corpus::Start start{0, 1};
+    if (options.shard && i == options.start.file)
+      start = {options.start.offset, options.start.position};
+
+    try {
+      Corpus::ForEach(board_filename, start,
+                      [&](const Corpus::Entry& puzzle) {
+        std::uint64_t n = number++;
+        if (n < options.first)
+          return true;
+        if (!in_range(n))
+          return false;
+
+        block.push_back({board_filename + ":" +
+                           std::to_string(puzzle.position),
+                         puzzle,
+                         Game::SolveResult::Invalid(Board(), ""),
+                         Grader::Grade::Ungraded()});
+        if (block.size() == kBlockSize)
+          flush();
+        return true;
+      });
+    } catch (const std::exception& e) {
+      // the rest of the file couldn't be read; that counts as one puzzle
+      if (!in_range(number++))
+        continue;
+
+      flush();
+      ++totals.puzzles;
+      ++totals.invalid;
+      std::cout << board_filename << ": invalid: " << e.what() << '\n';
+    }
+  }
+
+  flush();
+  if (options.shard)
+    output_shard_totals(totals);
+  else
+    output_batch_totals(totals, options);
+
+  return totals.solved == totals.puzzles ? kSuccess : kUnableToSolve;
+}
+
+// the number of puzzles batch would count in the files, and where every
+// shard_size-th one starts
+std::uint64_t scan_puzzles(const std::vector<std::string>& board_filenames,
+                           std::uint64_t shard_size,
+                           std::vector<ShardRunner::Start> *starts) {
+  std::uint64_t puzzles = 0;
+
+  for (std::size_t i = 0; i < board_filenames.size(); ++i) {
+    auto add = [&](const Corpus::Start& start) {
+      if (puzzles++ % shard_size == 0)
+        starts->push_back({i, start.offset, start.position});
+    };
+
+    try {
+      Corpus::Scan(board_filenames[i], add);
+    } catch (const std::exception&) {
+      // batch fails on the file wherever it starts reading it
+      add({0, 1});
+    }
+  }
+
+  return puzzles;
+}
+
+// run a batch as separate worker processes over shards of the puzzles,
+// then put their outputs and totals together in puzzle order
+//
+// The shard directory keeps a manifest of finished shards, so running the
+// same command again after a crash only redoes the unfinished ones.
+int sharded_batch(const std::string& program, const std::string& shard_dir,
+                  std::uint64_t shard_size, unsigned workers,
+                  const std::vector<std::string>& worker_command,
+                  const std::vector<std::string>& board_filenames,
+                  const BatchOptions& options) {
+  ShardRunner runner(shard_dir, worker_command);
+  if (!runner.planned()) {
+    if (shard_size == 0)
+      throw std::invalid_argument("Shard size must be at least 1");
+
+    std::vector<ShardRunner::Start> starts;
+    std::uint64_t puzzles = scan_puzzles(board_filenames, shard_size,
+                                         &starts);
+    runner.Plan(puzzles, shard_size, starts);
+  }
+
+  // workers exit with kUnableToSolve when some of their puzzles weren't
+  // solved, which is still a finished shard
+  if (std::size_t failed = runner.Run(program, workers, kUnableToSolve);
+      failed > 0) {
+    std::cout << failed << " shards failed; run again to retry them.\n";
+    return kUnableToSolve;
+  }
+
+  BatchTotals totals;
+
+  for (const auto& shard : runner.shards()) {
+    std::ifstream fs(runner.OutputFilename(shard));
+    if (!fs.is_open())
+      throw std::runtime_error("Missing " + runner.OutputFilename(shard));
+
+    std::vector<std::string> lines;
+    for (std::string line; std::getline(fs, line);)
+      lines.push_back(line);
+
+    // the totals are the last line
+    if (lines.empty() || !add_shard_totals(lines.back(), &totals))
+      throw std::runtime_error(runner.OutputFilename(shard) +
+                               " is incomplete");
+
+    for (std::size_t i = 0; i + 1 < lines.size(); ++i)
+      std::cout << lines[i] << '\n';
+  }
+
+  output_batch_totals(totals, options);
+
+  return totals.solved == totals.puzzles ? kSuccess : kUnableToSolve;
+}
+
+int batch(int argc, char const *argv[]) {
+  BatchOptions options;
+  std::vector<std::string> board_filenames;
+
+  std::string shard_dir;
+  std::uint64_t shard_size = 100000;
+  unsigned workers = 0;
+  // everything but the sharding options is passed on to the workers
+  std::vector<std::string> worker_command = {argv[1]};
+
+  for (int i = 2; i < argc; ++i) {
+    std::string arg = argv[i];
+    bool has_value = i + 1 < argc;
+
+    if (arg == "--shard-dir" && has_value) {
+      shard_dir = argv[++i];
+      continue;
+    } else if (arg == "--shard-size" && has_value) {
+      shard_size = std::stoull(argv[++i]);
+      continue;
+    } else if (arg == "--workers" && has_value) {
+      workers = std::stoul(argv[++i]);
+      continue;
+    }
+
+    int first_arg = i;
+
+    if (arg == "--timeout-ms" && has_value)
+      options.timeout_ms = std::stoull(argv[++i]);
+    else if (arg == "--max-steps" && has_value)
+      options.max_steps = std::stoull(argv[++i]);
+    else if (arg == "--max-nodes" && has_value)
+      options.max_nodes = std::stoull(argv[++i]);
+    else if (arg == "--jobs" && has_value)
+      options.jobs = std::stoul(argv[++i]);
+    else if (arg == "--grade")
+      options.grade = true;
+    else if (arg == "--lanes")
+      options.lanes = true;
+    else if (arg == "--range" && i + 2 < argc) {
+      options.first = std::stoull(argv[++i]);
+      options.count = std::stoull(argv[++i]);
+    } else if (arg == "--shard" && i + 5 < argc) {
+      options.shard = true;
+      options.first = std::stoull(argv[++i]);
+      options.count = std::stoull(argv[++i]);
+      options.start.file = std::stoull(argv[++i]);
+      options.start.offset = std::stoull(argv[++i]);
+      options.start.position = std::stoull(argv[++i]);
+    } else
+      board_filenames.push_back(arg);
+
+    worker_command.insert(worker_command.end(), argv + first_arg,
+                          argv + i + 1);
+  }
+
+  if (options.jobs == 0)
+    options.jobs = DefaultJobs();
+
+  if (workers == 0)
+    workers = DefaultJobs();
+
+  if (board_filenames.empty()) {
+    std::cout << "Missing game board file.\n";
+    return kNoBoard;
+  }
+
+  if (!shard_dir.empty()) {
+    return sharded_batch(argv[0], shard_dir, shard_size, workers,
+                         worker_command, board_filenames, options);
+  }
+
+  return batch(board_filenames, options);
+}
+
+struct ValidateTotals {
+  std::uint64_t solved = 0;
+  std::uint64_t incomplete = 0;
+  std::uint64_t invalid = 0;
+  std::uint64_t unreadable = 0;
+};
+
+void output_validation(const std::string& label,
+                       const Board::BoardValidationResult& result,
+                       ValidateTotals *totals) {
+  if (result.solved) {
+    ++totals->solved;
+  } else if (result.valid) {
+    ++totals->incomplete;
+    std::cout << label << ": incomplete\n";
+  } else {
+    ++totals->invalid;
+    std::cout << label << ": " << result.validation_message << '\n';
+  }
+}
+
+// check grids, usually submitted solutions, without solving anything;
+// only problems are printed
+int validate(const std::vector<std::string>& filenames) {
+  ValidateTotals totals;
+
+  for (const std::string& filename : filenames) {
+    try {
+      std::ifstream fs(filename, std::ifstream::in | std::ifstream::binary);
+      if (Board::IsSnapshot(fs)) {
+        Corpus::ForEach(filename, [&](const Corpus::Entry& entry) {
+          output_validation(filename + ":" + std::to_string(entry.position),
+                            entry.board.Validate(), &totals);
+          return true;
+        });
+        continue;
+      }
+      fs.close();
+
+      // straight from the parser into the bitmask checks, with no boards
+      MappedFile file(filename);
+      PuzzleParser parser(file.begin(), file.end());
+      PuzzleParser::Puzzle grid;
+
+      while (true) {
+        try {
+          if (!parser.Next(&grid))
+            break;
+        } catch (const PuzzleParser::ParseError& e) {
+          ++totals.unreadable;
+          std::cout << filename << ":" << e.line() << ": " << e.what()
+                    << '\n';
+          continue;
+        }
 
+        auto result = Board::ValidateGrid(grid);
+        if (!result.solved) {
+          output_validation(
+              filename + ":" + std::to_string(parser.puzzle_line()), result,
+              &totals);
+        } else {
+          ++totals.solved;
+        }
+      }
+    } catch (const std::exception& e) {
+      ++totals.unreadable;
+      std::cout << filename << ": " << e.what() << '\n';
+    }
+  }
+
+  std::cout << "Solved: " << totals.solved
+            << ", incomplete: " << totals.incomplete
+            << ", invalid: " << totals.invalid
+            << ", unreadable: " << totals.unreadable << '\n';
+
+  bool all_solved = totals.incomplete == 0 && totals.invalid == 0 &&
+                    totals.unreadable == 0;
+  return all_solved ? kSuccess : kInvalidBoard;
+}
+
+// show the next deduction for a cell ("Ab") or unit ("row 3"), and how
+// long it took to find
+int hint(int argc, char const *argv[]) {
+  if (argc < 4) {
+    std::cout << "Missing game board file, cell or unit.\n";
+    return kNoBoard;
+  }
+
+  Game game = Game(argv[2]);
+  std::string target = argv[3];
+
+  auto start = std::chrono::steady_clock::now();
+  Hints::Hint result = Hints::Hint::None("");
+
+  if (target.size() == 2 && target[0] >= 'A' && target[0] <= 'I' &&
+      target[1] >= 'a' && target[1] <= 'i') {
+    result = game.HintForCell(target[0] - 'A' + 1, target[1] - 'a' + 1);
+  } else if (argc >= 5) {
+    std::string number = argv[4];
+    if (number.size() != 1 || number[0] < '1' || number[0] > '9') {
+      std::cout << "Unit number must be 1 to 9.\n";
+      return kNoBoard;
+    }
+
+    if (target == "row") {
+      result = game.HintForUnit(Hints::UnitType::kRow, number[0] - '0');
+    } else if (target == "column") {
+      result = game.HintForUnit(Hints::UnitType::kColumn, number[0] - '0');
+    } else if (target == "box") {
+      result = game.HintForUnit(Hints::UnitType::kBox, number[0] - '0');
+    } else {
+      std::cout << "Unit must be row, column, or box.\n";
+      return kNoBoard;
+    }
+  } else {
+    std::cout << "Cell must be like Ab.\n";
+    return kNoBoard;
+  }
+
+  auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start);
+
+  std::cout << game.board().ToString(result.cells_to_highlight) << '\n'
+            << result.description << '\n'
+            << "Found in " << elapsed.count() << " us\n";
+
+  return kSuccess;
+}
+
+// change clues one at a time, as an editor would, and report after each
+// edit whether the puzzle still has exactly one solution
+int edit(int argc, char const *argv[]) {
+  if (argc < 5 || (argc - 3) % 2 != 0) {
+    std::cout << "Missing game board file, or a cell without a digit.\n";
+    return kNoBoard;
+  }
+
+  Game game = Game(argv[2]);
+  Game::EditResult result{Game::EditResult::Status::kNoSolution, 0};
+
+  for (int i = 3; i + 1 < argc; i += 2) {
+    std::string target = argv[i];
+    if (target.size() != 2 || target[0] < 'A' || target[0] > 'I' ||
+        target[1] < 'a' || target[1] > 'i') {
+      std::cout << "Cell must be like Ab.\n";
+      return kNoBoard;
+    }
+
+    std::string digit_arg = argv[i + 1];
+    if (digit_arg.size() != 1 || digit_arg[0] < '0' || digit_arg[0] > '9') {
+      std::cout << "Digit must be 1 to 9, or 0 to clear the cell.\n";
+      return kNoBoard;
+    }
+    int digit = digit_arg[0] - '0';
+
+    auto start = std::chrono::steady_clock::now();
+    result = game.SetClue(target[0] - 'A' + 1, target[1] - 'a' + 1, digit);
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start);
+
+    std::cout << target << (digit == 0 ? " cleared: "
+                                       : " = " + std::to_string(digit) + ": ");
+    switch (result.status) {
+      case Game::EditResult::Status::kUnique:
+        std::cout << "unique";
+        break;
+      case Game::EditResult::Status::kNoSolution:
+        std::cout << "no solution";
+        break;
+      case Game::EditResult::Status::kMultipleSolutions:
+        std::cout << "more than one solution";
+        break;
+    }
+    std::cout << " (" << result.steps << " steps, " << elapsed.count()
+              << " us)\n";
+  }
+
+  std::cout << game.board().ToString() << '\n';
+
+  return result.status == Game::EditResult::Status::kUnique
+    ? kSuccess : kUnableToSolve;
+}
+
+// write every solution of a board, or the first --limit of them, as
+// 81-digit lines or as a snapshot file; progress and totals go to stderr
+int enumerate(int argc, char const *argv[]) {
+  if (argc < 3) {
+    std::cout << "Missing game board file.\n";
+    return kNoBoard;
+  }
+
+  Enumerator::Options options;
+  std::string output_filename;
+  bool snapshot_format = false;
+
+  for (int i = 3; i < argc; ++i) {
+    std::string arg = argv[i];
+    bool has_value = i + 1 < argc;
+
+    if (arg == "--limit" && has_value)
+      options.limit = std::stoull(argv[++i]);
+    else if (arg == "--jobs" && has_value)
+      options.jobs = std::stoul(argv[++i]);
+    else if (arg == "--progress-ms" && has_value)
+      options.progress_interval = std::chrono::milliseconds(
+          std::stoull(argv[++i]));
+    else if (arg == "--output" && has_value)
+      output_filename = argv[++i];
+    else if (arg == "--format" && has_value)
+      snapshot_format = std::string(argv[++i]) == "snapshot";
+    else
+      throw std::invalid_argument("Unknown option " + arg);
+  }
+
+  if (options.jobs == 0)
+    options.jobs = DefaultJobs();
+
+  Game game = Game(argv[2]);
+
+  std::ofstream fs;
+  if (!output_filename.empty()) {
+    fs.open(output_filename, std::ofstream::out | std::ofstream::binary);
+    if (!fs.is_open())
+      throw std::runtime_error("Couldn't write " + output_filename);
+  }
+  std::ostream& os = output_filename.empty() ? std::cout : fs;
+
+  if (snapshot_format)
+    Board::WriteSnapshotHeader(os, game.board().layout());
+
+  Enumerator enumerator(options);
+  enumerator.set_progress_callback([](const Enumerator::Stats& stats) {
+    std::cerr << stats.solutions << " solutions, " << stats.nodes
+              << " nodes so far\n";
+  });
+
+  auto stats = enumerator.Enumerate(
+      game.board(), [&](const Enumerator::Grid& grid) {
+        if (snapshot_format) {
+          Board(grid).WriteSnapshot(os);
+        } else {
+          char line[82];
+          for (std::size_t i = 0; i < 81; ++i)
+            line[i] = static_cast<char>('0' + grid[i]);
+          line[81] = '\n';
+          os.write(line, sizeof(line));
+        }
+        return static_cast<bool>(os);
+      });
+
+  os.flush();
+  if (!os)
+    throw std::runtime_error("Couldn't write the solutions");
+
+  std::cerr << "Solutions: " << stats.solutions
+            << (stats.complete ? "" : " (stopped early)")
+            << ", nodes: " << stats.nodes << '\n';
+
+  return stats.solutions > 0 ? kSuccess : kUnableToSolve;
+}
+
+// step a game partway and save it, so it can be resumed or handed on
+int snapshot(int argc, char const *argv[]) {
+  if (argc < 4) {
+    std::cout << "Missing game board or snapshot file.\n";
+    return kNoBoard;
+  }
+
+  std::uint64_t max_steps = std::numeric_limits<std::uint64_t>::max();
+  if (argc >= 6 && std::string(argv[4]) == "--max-steps")
+    max_steps = std::stoull(argv[5]);
+
+  Game game = Game(argv[2]);
+
+  if (auto result = game.ValidateBoard(); !result.valid) {
+    std::cout << result.validation_message << "\n";
+    return kInvalidBoard;
+  }
+
+  std::uint64_t steps = 0;
+  while (steps < max_steps && !game.Step().done)
+    ++steps;
+
+  game.SaveSnapshot(argv[3]);
+  std::cout << "Saved " << argv[3] << " after " << steps << " steps\n";
+
+  return kSuccess;
+}
+
+// report the clues of each puzzle that aren't needed for it to be unique,
+// and the puzzle with as many of them removed as possible
+int minimize(int argc, char const *argv[]) {
+  unsigned jobs = 0;
+  int first_file = 2;
+  if (argc >= 4 && std::string(argv[2]) == "--jobs") {
+    jobs = std::stoul(argv[3]);
+    first_file = 4;
+  }
+
+  if (first_file >= argc) {
+    std::cout << "Missing game board file.\n";
+    return kNoBoard;
+  }
+
+  if (jobs == 0)
+    jobs = DefaultJobs();
+
+  std::uint64_t minimal = 0, reduced = 0, not_unique = 0, invalid = 0;
+
+  for (int i = first_file; i < argc; ++i) {
+    std::string filename = argv[i];
+
+    try {
+      Corpus::ForEach(filename, [&](const Corpus::Entry& entry) {
+        std::cout << filename << ":" << entry.position << ": ";
+
+        if (!entry.valid) {
+          ++invalid;
+          std::cout << "invalid: " << entry.error << '\n';
+          return true;
+        }
+
+        if (auto result = entry.board.Validate(); !result.valid) {
+          ++invalid;
+          std::cout << "invalid: " << result.validation_message << '\n';
+          return true;
+        }
+
+        auto result = Minimizer::Analyze(entry.board, jobs);
+        if (!result.unique) {
+          ++not_unique;
+          std::cout << (result.solvable ? "more than one solution"
+                                        : "no solution") << '\n';
+          return true;
+        }
+
+        if (result.redundant.empty()) {
+          ++minimal;
+          std::cout << "minimal\n";
+          return true;
+        }
+
+        ++reduced;
+        std::cout << result.redundant.size() << " redundant clues (";
+        for (std::size_t j = 0; j < result.redundant.size(); ++j) {
+          std::size_t cell = result.redundant[j];
+          std::cout << (j > 0 ? ", " : "")
+                    << entry.board.cell(cell / 9 + 1, cell % 9 + 1)
+                         ->DescribeLocation();
+        }
+        std::cout << "), minimal: ";
+        for (int digit : result.minimal)
+          std::cout << (digit > 0 ? static_cast<char>('0' + digit) : '.');
+        std::cout << '\n';
+
+        return true;
+      });
+    } catch (const std::exception& e) {
+      // the rest of the file couldn't be read; that counts as one puzzle
+      ++invalid;
+      std::cout << filename << ": invalid: " << e.what() << '\n';
+    }
+  }
+
+  std::cout << "Minimal: " << minimal << ", reduced: " << reduced
+            << ", not unique: " << not_unique << ", invalid: " << invalid
+            << '\n';
+
+  return invalid == 0 ? kSuccess : kInvalidBoard;
+}
+
+// solve a game, recording each step in a binary trace for --replay
+int trace(int argc, char const *argv[]) {
+  if (argc < 4) {
+    std::cout << "Missing game board or trace file.\n";
+    return kNoBoard;
+  }
+
+  Game game = Game(argv[2]);
+
+  if (auto result = game.ValidateBoard(); !result.valid) {
+    std::cout << result.validation_message << "\n";
+    return kInvalidBoard;
+  }
+
+  try {
+    SolveTrace::Writer trace(argv[3], game.board());
+    game.set_trace(&trace);
+    auto result = game.Solve();
+    trace.Close();
+
+    bool solved = result.status == Game::SolveResult::Status::kSolved;
+    std::cout << (solved ? "Solved" : "Not solved") << ", saved "
+              << trace.steps() << " steps in " << argv[3] << '\n';
+
+    return solved ? kSuccess : kUnableToSolve;
+  } catch (const std::exception& e) {
+    std::cout << e.what() << '\n';
+    return kNoBoard;
+  }
+}
+
+// show the board as of one step of a trace, or the end of it
+int replay(int argc, char const *argv[]) {
+  if (argc < 3) {
+    std::cout << "Missing trace file.\n";
+    return kNoBoard;
+  }
+
+  // short enough that std::stoull can't overflow
+  bool seek = argc >= 5 && std::string(argv[3]) == "--step";
+  std::string step = seek ? argv[4] : "";
+  if (seek && (step.empty() || step.size() > 18 ||
+               step.find_first_not_of("0123456789") != std::string::npos)) {
+    std::cout << "Step must be a number.\n";
+    return kNoBoard;
+  }
+
+  try {
+    SolveTrace::Reader trace(argv[2]);
+
+    if (seek) {
+      if (!trace.Seek(std::stoull(step)))
+        std::cout << "The trace only has " << trace.step() << " steps\n";
+    } else {
+      while (trace.Next()) {}
+    }
+
+    std::cout << trace.board().ToString(trace.cells_changed()) << '\n'
+              << "Step " << trace.step();
+    if (!trace.technique().empty())
+      std::cout << ": " << trace.technique();
+    std::cout << '\n';
+  } catch (const std::exception& e) {
+    std::cout << argv[2] << ": " << e.what() << '\n';
+    return kNoBoard;
+  }
+
+  return kSuccess;
+}
+
+int main(int argc, char const *argv[]) {
   if (argc < 2) {
     std::cout << "Call the program with a game board file.\n";
     std::cout << "Example:\n";
     std::cout << "  " << argv[0] << " board.txt\n";
+    std::cout << "Options:\n";
+    std::cout << "  " << argv[0] << " --search board.txt\n";
+    std::cout << "  " << argv[0] << " --batch [--timeout-ms N] "
+              << "[--max-steps N] [--max-nodes N] [--grade] [--jobs N] "
+              << "[--lanes] board.txt...\n";
+    std::cout << "  " << argv[0] << " --batch --shard-dir DIR "
+              << "[--shard-size N] [--workers N] [batch options] "
+              << "board.txt...\n";
+    std::cout << "  " << argv[0] << " --hint board.txt Ab\n";
+    std::cout << "  " << argv[0] << " --hint board.txt row|column|box N\n";
+    std::cout << "  " << argv[0] << " --edit board.txt Ab DIGIT "
+              << "[Cd DIGIT...]\n";
+    std::cout << "  " << argv[0] << " --snapshot board.txt saved.snap "
+              << "[--max-steps N]\n";
+    std::cout << "  " << argv[0] << " --validate solutions.txt...\n";
+    std::cout << "  " << argv[0] << " --enumerate board.txt [--limit N] "
+              << "[--jobs N] [--progress-ms N] [--output FILE] "
+              << "[--format lines|snapshot]\n";
+    std::cout << "  " << argv[0] << " --minimize [--jobs N] board.txt...\n";
+    std::cout << "  " << argv[0] << " --trace board.txt solve.trace\n";
+    std::cout << "  " << argv[0] << " --replay solve.trace [--step N]\n";
+    std::cout << "Any board file can also be a saved snapshot.\n";
     return kNoBoard;
   }
 
+  if (std::string(argv[1]) == "--validate") {
+    if (argc < 3) {
+      std::cout << "Missing game board file.\n";
+      return kNoBoard;
+    }
+
+    return validate(std::vector<std::string>(argv + 2, argv + argc));
+  }
+
+  if (std::string(argv[1]) == "--snapshot")
+    return snapshot(argc, argv);
+
+  if (std::string(argv[1]) == "--enumerate")
+    return enumerate(argc, argv);
+
+  if (std::string(argv[1]) == "--minimize")
+    return minimize(argc, argv);
+
+  if (std::string(argv[1]) == "--trace")
+    return trace(argc, argv);
+
+  if (std::string(argv[1]) == "--replay")
+    return replay(argc, argv);
+
+  if (std::string(argv[1]) == "--edit")
+    return edit(argc, argv);
+
+  if (std::string(argv[1]) == "--hint")
+    return hint(argc, argv);
+
+  if (std::string(argv[1]) == "--batch")
+    return batch(argc, argv);
+
+  if (std::string(argv[1]) == "--search") {
+    if (argc < 3) {
+      std::cout << "Missing game board file.\n";
+      return kNoBoard;
+    }
+
+    return search(argv[2]);
+  }
+
   Game game = Game(argv[1]);
 
   output_board(game.board(), {}, "Initial board\n");
@@ -36,18 +1050,22 @@ int main(int argc, char const *argv[]) {
     return kInvalidBoard;
   }
 
+  // the next steps are worked out while the user looks at this one
+  StepPipeline pipeline(game, kStepsAhead);
+  std::shared_ptr<const StepPipeline::Frame> frame;
+
   while (true) {
-    auto result = game.Step();
-    if (result.done)
+    frame = pipeline.Next();
+    if (frame->done)
       break;
 
     std::ostringstream description;
-    for (std::string change_description : result.change_descriptions)
+    for (std::string change_description : frame->change_descriptions)
       description << change_description << '\n';
-    output_board(game.board(), result.cells_changed, description.str());
+    output_board(frame->board, frame->cells_changed, description.str());
   }
 
-  if (auto result = game.ValidateBoard(); result.solved) {
+  if (auto result = frame->board.Validate(); result.solved) {
     return kSuccess;
   } else {
     return kUnableToSolve;
@@ -0,0 +1,55 @@
+#include <fcntl.h>  // for open
+#include <sys/mman.h>  // for mmap, munmap, madvise
+#include <sys/stat.h>  // for fstat
+#include <unistd.h>  // for close
+
+#include <stdexcept>  // for std::runtime_error
+
+#include "mapped_file.h"
+
+MappedFile::MappedFile(const std::string& filename)
+    : data_(nullptr), size_(0) {
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw std::runtime_error("Couldn't open " + filename);
+
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0) {
+    close(fd);
+    throw std::runtime_error("Couldn't read " + filename);
+  }
+
+  size_ = file_stat.st_size;
+
+  // mapping an empty file fails, and there's nothing to read anyway
+  if (size_ > 0) {
+    void *data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+      close(fd);
+      throw std::runtime_error("Couldn't map " + filename);
+    }
+
+    // puzzles are read front to back
+    madvise(data, size_, MADV_SEQUENTIAL);
+    data_ = static_cast<const char *>(data);
+  }
+
+  close(fd);
+}
+
+MappedFile::~MappedFile() {
+  if (data_)
+    munmap(const_cast<char *>(data_), size_);
+}
+
+const char *MappedFile::begin() const {
+  return data_;
+}
+
+const char *MappedFile::end() const {
+  return data_ + size_;
+}
+
+std::size_t MappedFile::size() const {
+  return size_;
+}
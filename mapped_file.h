@@ -0,0 +1,26 @@
+#ifndef MAPPED_FILE_H_
+#define MAPPED_FILE_H_
+
+#include <cstddef>  // for std::size_t
+#include <string>
+
+// read-only view of a whole file, mapped into memory so that even huge
+// puzzle collections can be read without copying them
+class MappedFile {
+ public:
+  explicit MappedFile(const std::string& filename);
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  const char *begin() const;
+  const char *end() const;
+  std::size_t size() const;
+
+ private:
+  const char *data_;
+  std::size_t size_;
+};
+
+#endif
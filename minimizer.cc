@@ -0,0 +1,80 @@
+#include "minimizer.h"
+#include "parallel.h"
+
+Minimizer::Result Minimizer::Analyze(const Board& board, unsigned jobs) {
+  Result result{false, false, {}, {}, {}};
+
+  Enumerator::Grid clues;
+  for (std::size_t i = 0; i < 81; ++i) {
+    const Cell *cell = board.cell(i / 9 + 1, i % 9 + 1);
+    clues[i] = cell->solved() ? cell->solution() : 0;
+  }
+
+  Board puzzle(clues);
+  puzzle.set_layout(board.shared_layout());
+
+  // stops at a second solution
+  Enumerator::Options options;
+  options.limit = 1;
+  auto stats = Enumerator(options).Enumerate(
+      puzzle, [&](const Enumerator::Grid& grid) {
+        result.solution = grid;
+        return true;
+      });
+
+  result.solvable = stats.solutions > 0;
+  if (stats.solutions != 1 || !stats.complete)
+    return result;
+  result.unique = true;
+
+  std::vector<std::size_t> filled;
+  for (std::size_t i = 0; i < 81; ++i) {
+    if (clues[i] != 0)
+      filled.push_back(i);
+  }
+
+  // not std::vector<bool>, whose elements can't be set from different
+  // threads at once
+  std::vector<char> redundant(filled.size());
+  ParallelFor(filled.size(), jobs, [&](std::size_t i) {
+    redundant[i] = Redundant(board, clues, result.solution, filled[i]);
+  });
+
+  for (std::size_t i = 0; i < filled.size(); ++i) {
+    if (redundant[i])
+      result.redundant.push_back(filled[i]);
+  }
+
+  // Removing a clue can only add solutions, so a clue that's needed now is
+  // still needed once others are gone, and only the redundant ones have to
+  // be tried again. They aren't independent, though: two of them may not
+  // both be removable, so each is tried against what's left so far.
+  result.minimal = clues;
+  for (std::size_t cell : result.redundant) {
+    if (Redundant(board, result.minimal, result.solution, cell))
+      result.minimal[cell] = 0;
+  }
+
+  return result;
+}
+
+bool Minimizer::Redundant(const Board& board, const Enumerator::Grid& clues,
+                          const Enumerator::Grid& solution,
+                          std::size_t cell) {
+  Enumerator::Grid without = clues;
+  without[cell] = 0;
+
+  Board puzzle(without);
+  puzzle.set_layout(board.shared_layout());
+
+  // any solution with another digit in the cell would be a second one
+  auto guesses = Cell::CellGuesses::FromMask(Cell::CellGuesses::kAll);
+  guesses.erase(solution[cell]);
+  puzzle.SetGuesses(puzzle.cell(cell / 9 + 1, cell % 9 + 1), guesses);
+
+  auto stats = Enumerator().Enumerate(puzzle, [](const Enumerator::Grid&) {
+    return false;
+  });
+
+  return stats.solutions == 0;
+}
@@ -0,0 +1,46 @@
+#ifndef MINIMIZER_H_
+#define MINIMIZER_H_
+
+#include <cstddef>  // for std::size_t
+#include <vector>
+
+#include "board.h"
+#include "enumerator.h"
+
+// finds the clues of a puzzle that could be removed without it gaining a
+// second solution
+//
+// The checks all share the puzzle's one solution S. Removing the clue in
+// cell c keeps the puzzle unique exactly when no solution has something
+// other than S[c] in c, so each check is a search for such a solution
+// rather than a count of them all, and most fail within a few nodes. The
+// clues are independent of each other, so they are checked in parallel.
+class Minimizer {
+ public:
+  struct Result {
+    // false if the puzzle doesn't have exactly one solution, in which case
+    // nothing else is filled in
+    bool unique;
+    // whether there was any solution, when it isn't unique
+    bool solvable;
+    Enumerator::Grid solution;
+    // cells, in row order, whose clue can be removed on its own
+    std::vector<std::size_t> redundant;
+    // the clues, with 0 for blank cells, once as many of the redundant ones
+    // as possible have been removed
+    Enumerator::Grid minimal;
+  };
+
+  // uses only the solved cells of the board as clues
+  static Result Analyze(const Board& board, unsigned jobs);
+
+ private:
+  Minimizer() {}  // prevent instantiating this class
+
+  // whether the clues still have only the one solution without the clue in
+  // the cell
+  static bool Redundant(const Board& board, const Enumerator::Grid& clues,
+                        const Enumerator::Grid& solution, std::size_t cell);
+};
+
+#endif
@@ -4,6 +4,23 @@
 
 #include "operators.h"
 
+const std::vector<Operators::Technique>& Operators::Techniques() {
+  static const std::vector<Technique> techniques = {
+    {"Fill in guesses", 0, FillInGuesses},
+    {"Single guess", 10, SingleGuessRule},
+    {"Hidden single", 12, HiddenSingleGuessRule},
+    {"Cage sum", 16, CageSumRule},
+    {"X-Wing", 20, XWingRule},
+    {"Finned X-Wing", 24, FinnedXWingRule},
+    {"Swordfish", 30, SwordfishRule},
+    {"Finned Swordfish", 34, FinnedSwordfishRule},
+    {"Jellyfish", 40, JellyfishRule},
+    {"Finned Jellyfish", 44, FinnedJellyfishRule},
+  };
+
+  return techniques;
+}
+
 Operators::OperationResult Operators::FillInGuesses(Board& board) {
   std::set<const Cell *> cells_changed;
 
@@ -13,7 +30,7 @@ Operators::OperationResult Operators::FillInGuesses(Board& board) {
     for (std::size_t j = 1; j <= 9; ++j) {
       if (Cell *cell = row[j - 1]; !cell->solved()) {
         if (cell->guesses().empty()) {
-          cell->set_guesses({1, 2, 3, 4, 5, 6, 7, 8, 9});
+          board.SetGuesses(cell, {1, 2, 3, 4, 5, 6, 7, 8, 9});
           cells_changed.insert(cell);
         }
       }
@@ -36,7 +53,7 @@ Operators::OperationResult Operators::SingleGuessRule(Board& board) {
         auto guesses = cell->guesses();
         if (guesses.size() == 1) {
           int single_guess = *guesses.cbegin();
-          cell->set_solution(single_guess);
+          board.SetSolution(cell, single_guess);
           cells_changed.insert(cell);
         }
       }
@@ -53,49 +70,28 @@ Operators::OperationResult Operators::HiddenSingleGuessRule(Board& board) {
   std::vector<CellChange> changes;
   std::vector<std::string> change_descriptions;
 
-  for (std::size_t i = 1; i <= 9; ++i) {
-    auto cell_list = board.row(i);
-    auto region_changes = HiddenSingleGuessRuleSingleRegion(cell_list);
-    for (auto change : region_changes) {
-      changes.push_back(change);
+  // only units that hold every digit; a small cage needn't have them all
+  const auto& units = board.layout().units();
+  for (std::size_t i = 0; i < units.size(); ++i) {
+    if (!units[i].complete())
+      continue;
 
-      std::ostringstream description;
-      description << "Cell " << change.cell->DescribeLocation()
-                  << " had the only " << change.solution << " in its row";
-      change_descriptions.push_back(description.str());
-    }
-  }
-
-  for (std::size_t i = 1; i <= 9; ++i) {
-    auto cell_list = board.col(i);
+    auto cell_list = board.unit(i);
     auto region_changes = HiddenSingleGuessRuleSingleRegion(cell_list);
     for (auto change : region_changes) {
       changes.push_back(change);
 
       std::ostringstream description;
       description << "Cell " << change.cell->DescribeLocation()
-                  << " had the only " << change.solution << " in its column";
-      change_descriptions.push_back(description.str());
-    }
-  }
-
-  for (std::size_t i = 1; i <= 9; ++i) {
-    auto cell_list = board.box(i);
-    auto region_changes = HiddenSingleGuessRuleSingleRegion(cell_list);
-
-    for (auto change : region_changes) {
-      changes.push_back(change);
-
-      std::ostringstream description;
-      description << "Cell " << change.cell->DescribeLocation()
-                  << " had the only " << change.solution << " in its box";
+                  << " had the only " << change.solution << " in its "
+                  << Layout::KindName(units[i].kind);
       change_descriptions.push_back(description.str());
     }
   }
 
   std::set<const Cell *> cells_changed;
   for (auto change : changes) {
-    change.cell->set_solution(change.solution);
+    board.SetSolution(change.cell, change.solution);
     cells_changed.insert(change.cell);
   }
 
@@ -135,20 +131,80 @@ Operators::OperationResult Operators::HiddenSingleGuessRule(Board& board) {
   return {cells_changed, change_descriptions};
 }
 
-void Operators::TrimGuesses(Board& board) {
-  for (std::size_t i = 1; i <= 9; ++i) {
-    auto cell_list = board.row(i);
-    TrimGuessesSingleRegion(cell_list);
-  }
+Operators::OperationResult Operators::CageSumRule(Board& board) {
+  std::set<const Cell *> cells_changed;
+  std::vector<std::string> change_descriptions;
 
-  for (std::size_t i = 1; i <= 9; ++i) {
-    auto cell_list = board.col(i);
-    TrimGuessesSingleRegion(cell_list);
+  const auto& units = board.layout().units();
+  for (std::size_t i = 0; i < units.size(); ++i) {
+    if (units[i].sum == 0)
+      continue;
+
+    auto cell_list = board.unit(i);
+    auto allowed = CageSumRuleSingleCage(cell_list, units[i].sum);
+
+    std::vector<std::string> cell_names;
+    for (std::size_t j = 0; j < cell_list.size(); ++j) {
+      Cell *cell = cell_list[j];
+      if (cell->solved() || cell->guesses().empty())
+        continue;
+
+      auto guesses = cell->guesses();
+      auto trimmed = Cell::CellGuesses::FromMask(guesses.mask() & allowed[j]);
+      if (trimmed == guesses)
+        continue;
+
+      if (trimmed.empty())
+        throw std::logic_error("Cell has no possible guesses");
+
+      board.SetGuesses(cell, trimmed);
+      cells_changed.insert(cell);
+      cell_names.push_back(cell->DescribeLocation());
+    }
+
+    if (!cell_names.empty()) {
+      std::ostringstream description;
+      description << (cell_names.size() == 1 ? "Cell " : "Cells ");
+      for (std::size_t j = 0; j < cell_names.size(); ++j)
+        description << (j > 0 ? ", " : "") << cell_names[j];
+      description << " can only hold digits that add up to " << units[i].sum
+                  << " in " << Layout::KindName(units[i].kind) << " "
+                  << units[i].number;
+      change_descriptions.push_back(description.str());
+    }
   }
 
-  for (std::size_t i = 1; i <= 9; ++i) {
-    auto cell_list = board.box(i);
-    TrimGuessesSingleRegion(cell_list);
+  return {cells_changed, change_descriptions};
+}
+
+Operators::OperationResult Operators::XWingRule(Board& board) {
+  return FishRule(board, 2, false);
+}
+
+Operators::OperationResult Operators::SwordfishRule(Board& board) {
+  return FishRule(board, 3, false);
+}
+
+Operators::OperationResult Operators::JellyfishRule(Board& board) {
+  return FishRule(board, 4, false);
+}
+
+Operators::OperationResult Operators::FinnedXWingRule(Board& board) {
+  return FishRule(board, 2, true);
+}
+
+Operators::OperationResult Operators::FinnedSwordfishRule(Board& board) {
+  return FishRule(board, 3, true);
+}
+
+Operators::OperationResult Operators::FinnedJellyfishRule(Board& board) {
+  return FishRule(board, 4, true);
+}
+
+void Operators::TrimGuesses(Board& board) {
+  for (std::size_t i = 0; i < board.layout().units().size(); ++i) {
+    auto cell_list = board.unit(i);
+    TrimGuessesSingleRegion(board, cell_list);
   }
 }
 
@@ -171,7 +227,8 @@ std::vector<Operators::CellChange> Operators::HiddenSingleGuessRuleSingleRegion(
   return changes;
 }
 
-void Operators::TrimGuessesSingleRegion(const std::vector<Cell *>& cell_list) {
+void Operators::TrimGuessesSingleRegion(Board& board,
+                                        const std::vector<Cell *>& cell_list) {
   std::vector<int> solutions;
   for (Cell *cell : cell_list) {
     if (cell->solved())
@@ -180,10 +237,195 @@ void Operators::TrimGuessesSingleRegion(const std::vector<Cell *>& cell_list) {
 
   for (Cell *cell : cell_list) {
     if (!cell->solved()) {
-      for (int solution : solutions)
-        cell->remove_guess(solution);
+      for (int solution : solutions) {
+        if (cell->has_guess(solution))
+          board.RemoveGuess(cell, solution);
+      }
       if (cell->guesses().empty())
         throw std::logic_error("Cell has no possible guesses");
     }
   }
 }
+
+// for each cell, the digits it could take in some set of different digits
+// that adds up to sum, fits the solved cells, and can be spread over the
+// unsolved cells' guesses
+std::vector<std::uint16_t> Operators::CageSumRuleSingleCage(
+    const std::vector<Cell *>& cell_list, int sum) {
+  std::uint16_t solved = 0;
+  for (Cell *cell : cell_list) {
+    if (cell->solved())
+      solved |= 1 << cell->solution();
+  }
+
+  std::vector<std::uint16_t> allowed(cell_list.size(), 0);
+
+  // each digit combination is a mask in the same form as Guesses::mask
+  for (std::uint16_t digits = 0; digits <= Cell::CellGuesses::kAll;
+       digits += 2) {
+    if (static_cast<std::size_t>(__builtin_popcount(digits)) !=
+        cell_list.size() || (digits & solved) != solved)
+      continue;
+
+    int digits_sum = 0;
+    for (int digit : Cell::CellGuesses::FromMask(digits))
+      digits_sum += digit;
+    if (digits_sum != sum)
+      continue;
+
+    std::uint16_t open = digits & ~solved;
+    std::uint16_t reachable = 0;
+    bool fits = true;
+    for (Cell *cell : cell_list) {
+      if (cell->solved())
+        continue;
+
+      std::uint16_t guesses = cell->guesses().empty()
+        ? Cell::CellGuesses::kAll : cell->guesses().mask();
+      fits = fits && (guesses & open) != 0;
+      reachable |= guesses & open;
+    }
+
+    if (!fits || reachable != open)
+      continue;
+
+    for (std::size_t j = 0; j < cell_list.size(); ++j) {
+      if (!cell_list[j]->solved())
+        allowed[j] |= open;
+    }
+  }
+
+  // solved cells keep their digit
+  for (std::size_t j = 0; j < cell_list.size(); ++j) {
+    if (cell_list[j]->solved())
+      allowed[j] = 1 << cell_list[j]->solution();
+  }
+
+  return allowed;
+}
+
+Operators::OperationResult Operators::FishRule(Board& board, std::size_t size,
+                                               bool finned) {
+  const std::string kFishNames[] = {"", "", "X-Wing", "Swordfish",
+                                    "Jellyfish"};
+
+  std::set<const Cell *> cells_changed;
+  std::vector<std::string> change_descriptions;
+
+  for (int digit = 1; digit <= 9; ++digit) {
+    for (bool rows : {true, false}) {
+      // sets of lines are bitmasks, with bit n - 1 for line n; base lines
+      // run the way named by rows and cover lines run across them
+      std::uint16_t positions[9];
+      auto find_positions = [&]() {
+        for (std::size_t i = 0; i < 9; ++i) {
+          positions[i] = rows ? board.candidates(digit).RowBits(i + 1)
+                              : board.candidates(digit).ColumnBits(i + 1);
+        }
+      };
+      find_positions();
+
+      for (std::uint16_t base = 0; base < 0x200; ++base) {
+        if (static_cast<std::size_t>(__builtin_popcount(base)) != size)
+          continue;
+
+        std::uint16_t all_positions = 0;
+        bool usable = true;
+        for (std::size_t i = 0; i < 9; ++i) {
+          if ((base >> i) & 1) {
+            usable = usable && positions[i] != 0;
+            all_positions |= positions[i];
+          }
+        }
+
+        std::size_t position_count = __builtin_popcount(all_positions);
+        if (!usable || position_count < size)
+          continue;
+
+        // fins can only be spread over the three lines of one box
+        if (finned ? position_count == size || position_count > size + 3
+                   : position_count != size)
+          continue;
+
+        Bitboard candidates = board.candidates(digit);
+        Bitboard base_cells = Lines(rows, base);
+
+        // try each set of cover lines, leaving the rest as fins
+        for (std::uint16_t cover = all_positions; cover != 0;
+             cover = (cover - 1) & all_positions) {
+          if (static_cast<std::size_t>(__builtin_popcount(cover)) != size)
+            continue;
+
+          Bitboard targets = candidates & Lines(!rows, cover) & ~base_cells;
+
+          std::size_t fin_box = 0;
+          if (std::uint16_t fin_lines = all_positions & ~cover; fin_lines) {
+            Bitboard fins = candidates & base_cells & Lines(!rows, fin_lines);
+            std::size_t first_fin = *fins.cbegin();
+            fin_box = first_fin / 27 * 3 + first_fin % 9 / 3 + 1;
+
+            Bitboard box_cells = Bitboard::Box(fin_box);
+            if ((fins & ~box_cells) != Bitboard())
+              continue;
+
+            targets &= box_cells;
+          }
+
+          if (targets.empty())
+            continue;
+
+          std::ostringstream description;
+          description << (targets.size() == 1 ? "Cell " : "Cells ");
+          for (std::size_t index : targets) {
+            Cell *cell = board.cell(index / 9 + 1, index % 9 + 1);
+            board.RemoveGuess(cell, digit);
+            cells_changed.insert(cell);
+
+            if (cell->guesses().empty())
+              throw std::logic_error("Cell has no possible guesses");
+
+            if (index != *targets.cbegin())
+              description << ", ";
+            description << cell->DescribeLocation();
+          }
+
+          description << " can't be " << digit << " because of "
+                      << (finned ? "a finned " : size == 2 ? "an " : "a ")
+                      << kFishNames[size]
+                      << " in " << DescribeLines(rows, base);
+          if (finned)
+            description << " with fins in box " << fin_box;
+          change_descriptions.push_back(description.str());
+
+          find_positions();
+          break;
+        }
+      }
+    }
+  }
+
+  return {cells_changed, change_descriptions};
+}
+
+Bitboard Operators::Lines(bool rows, std::uint16_t line_bits) {
+  Bitboard result;
+  for (std::size_t i = 0; i < 9; ++i) {
+    if ((line_bits >> i) & 1)
+      result |= rows ? Bitboard::Row(i + 1) : Bitboard::Column(i + 1);
+  }
+
+  return result;
+}
+
+// uses the same letters as Cell::DescribeLocation
+std::string Operators::DescribeLines(bool rows, std::uint16_t line_bits) {
+  std::string result = rows ? "rows" : "columns";
+  for (std::size_t i = 0; i < 9; ++i) {
+    if ((line_bits >> i) & 1) {
+      result += result.back() == 's' ? " " : ", ";
+      result.push_back(static_cast<char>((rows ? 'A' : 'a') + i));
+    }
+  }
+
+  return result;
+}
@@ -1,8 +1,10 @@
 #ifndef OPERATORS_H_
 #define OPERATORS_H_
 
+#include <cstdint>  // for std::uint16_t
 #include <cstdlib>  // for std::size_t
 #include <set>
+#include <string>
 #include <vector>
 #include <utility>  // for std::pair
 
@@ -29,6 +31,16 @@ class Operators {
     }
   };
 
+  struct Technique {
+    std::string name;
+    // higher is harder; zero for bookkeeping that isn't a deduction
+    int difficulty;
+    OperationResult (*apply)(Board& board);
+  };
+
+  // the operators Game::Step tries, easiest first
+  static const std::vector<Technique>& Techniques();
+
   // fill in empty cells with all possible guesses
   static OperationResult FillInGuesses(Board& board);
 
@@ -39,6 +51,23 @@ class Operators {
   // row, column, or box
   static OperationResult HiddenSingleGuessRule(Board& board);
 
+  // remove guesses that can't be part of any set of different digits that
+  // adds up to a killer cage's sum
+  static OperationResult CageSumRule(Board& board);
+
+  // fish on one digit: if the digit's guesses in N rows all lie in the same
+  // N columns, it can't go anywhere else in those columns, and the same
+  // with rows and columns swapped
+  static OperationResult XWingRule(Board& board);
+  static OperationResult SwordfishRule(Board& board);
+  static OperationResult JellyfishRule(Board& board);
+
+  // fish with extra guesses, called fins, that all sit in one box; only
+  // the cells in the fins' box can lose the digit
+  static OperationResult FinnedXWingRule(Board& board);
+  static OperationResult FinnedSwordfishRule(Board& board);
+  static OperationResult FinnedJellyfishRule(Board& board);
+
   // remove invalid guesses
   static void TrimGuesses(Board& board);
 
@@ -56,7 +85,21 @@ class Operators {
   static std::vector<CellChange> HiddenSingleGuessRuleSingleRegion(
       const std::vector<Cell *>& cell_list);
 
-  static void TrimGuessesSingleRegion(const std::vector<Cell *>& cell_list);
+  static void TrimGuessesSingleRegion(Board& board,
+                                      const std::vector<Cell *>& cell_list);
+
+  // the digits, as in Guesses::mask, that each cell may keep
+  static std::vector<std::uint16_t> CageSumRuleSingleCage(
+      const std::vector<Cell *>& cell_list, int sum);
+
+  // size is the number of rows or columns in the fish, from 2 to 4
+  static OperationResult FishRule(Board& board, std::size_t size,
+                                  bool finned);
+
+  // the cells of the rows, or columns, with bit n - 1 set for line n
+  static Bitboard Lines(bool rows, std::uint16_t line_bits);
+
+  static std::string DescribeLines(bool rows, std::uint16_t line_bits);
 };
 
 #endif
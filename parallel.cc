@@ -0,0 +1,37 @@
+#include <algorithm>  // for std::min
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "parallel.h"
+
+void ParallelFor(std::size_t count, unsigned jobs,
+                 const std::function<void(std::size_t)>& body) {
+  std::size_t threads = std::min<std::size_t>(jobs, count);
+
+  if (threads <= 1) {
+    for (std::size_t i = 0; i < count; ++i)
+      body(i);
+    return;
+  }
+
+  std::atomic<std::size_t> next{0};
+  auto worker = [&]() {
+    for (std::size_t i = next++; i < count; i = next++)
+      body(i);
+  };
+
+  std::vector<std::thread> pool;
+  for (std::size_t i = 1; i < threads; ++i)
+    pool.emplace_back(worker);
+
+  worker();
+
+  for (std::thread& thread : pool)
+    thread.join();
+}
+
+unsigned DefaultJobs() {
+  unsigned jobs = std::thread::hardware_concurrency();
+  return jobs > 0 ? jobs : 1;
+}
@@ -0,0 +1,15 @@
+#ifndef PARALLEL_H_
+#define PARALLEL_H_
+
+#include <cstddef>  // for std::size_t
+#include <functional>
+
+// calls body(i) for each i below count on up to jobs threads, and returns
+// once all of them are done; the order of the calls is unspecified
+void ParallelFor(std::size_t count, unsigned jobs,
+                 const std::function<void(std::size_t)>& body);
+
+// the number of hardware threads, or one if that's unknown
+unsigned DefaultJobs();
+
+#endif
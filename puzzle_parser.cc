@@ -0,0 +1,220 @@
+#include "puzzle_parser.h"
+
+PuzzleParser::ParseError::ParseError(const std::string& message,
+                                     std::size_t line, std::size_t column)
+    : std::invalid_argument("Line " + std::to_string(line) + ", column " +
+                            std::to_string(column) + ": " + message),
+      line_(line), column_(column) {}
+
+std::size_t PuzzleParser::ParseError::line() const {
+  return line_;
+}
+
+std::size_t PuzzleParser::ParseError::column() const {
+  return column_;
+}
+
+PuzzleParser::PuzzleParser(const char *begin, const char *end)
+    : PuzzleParser(begin, end, 1) {}
+
+PuzzleParser::PuzzleParser(const char *begin, const char *end,
+                           std::size_t line)
+    : pos_(begin), end_(end), line_(line), puzzle_line_(0),
+      line_start_(begin), grid_rows_(0) {}
+
+bool PuzzleParser::Next(Puzzle *puzzle) {
+  // cells of the puzzle read so far, from earlier lines
+  std::size_t cells = 0;
+
+  while (pos_ < end_) {
+    if (cells == 0 && ReadPlainLine(puzzle))
+      return true;
+
+    const char *line_start = pos_;
+    line_start_ = line_start;
+    grid_rows_ = cells / 9;
+    std::size_t line_cells = 0;
+    std::size_t tenth_cell_column = 0;
+    std::size_t extra_cell_column = 0;
+    std::size_t separator_column = 0;
+
+    for (; pos_ < end_ && *pos_ != '\n'; ++pos_) {
+      char c = *pos_;
+      int value;
+
+      if (c >= '1' && c <= '9') {
+        value = c - '0';
+      } else if (c == '0' || c == '.' || c == '*' || c == '_') {
+        value = 0;
+      } else if (c == ' ' || c == '\t' || c == '\r' || c == '|') {
+        continue;
+      } else if (c == '-' || c == '+' || c == '=') {
+        // only allowed on lines that separate boxes
+        if (separator_column == 0)
+          separator_column = pos_ - line_start + 1;
+        continue;
+      } else if (c == '#') {
+        while (pos_ < end_ && *pos_ != '\n')
+          ++pos_;
+        break;
+      } else {
+        Fail(std::string("Unexpected character '") + c + "'", line_,
+             pos_ - line_start + 1);
+      }
+
+      if (std::size_t index = cells + line_cells; index < 81)
+        (*puzzle)[index] = value;
+
+      if (++line_cells == 10)
+        tenth_cell_column = pos_ - line_start + 1;
+      else if (line_cells == 82)
+        extra_cell_column = pos_ - line_start + 1;
+    }
+
+    std::size_t line = line_;
+    std::size_t line_end_column = pos_ - line_start + 1;
+    if (pos_ < end_)
+      ++pos_;
+    ++line_;
+
+    if (line_cells == 0)
+      continue;
+
+    if (separator_column != 0) {
+      Fail(std::string("Unexpected '") + line_start[separator_column - 1] +
+           "' on a line with cells", line, separator_column);
+    }
+
+    if (cells == 0)
+      puzzle_line_ = line;
+
+    if (line_cells == 81 && cells == 0)
+      return true;
+
+    if (line_cells == 9) {
+      cells += 9;
+      if (cells == 81)
+        return true;
+      continue;
+    }
+
+    // a whole puzzle cut the grid short; it's left for the next call
+    if (line_cells == 81) {
+      pos_ = line_start;
+      line_ = line;
+      throw ParseError("Board must have 9 rows", line, 1);
+    }
+
+    if (cells == 0 && line_cells > 81)
+      Fail("Puzzle must have 81 cells", line, extra_cell_column);
+    else if (cells == 0 && line_cells > kMaxRowCells)
+      Fail("Puzzle must have 81 cells", line, line_end_column);
+    else if (line_cells > 9)
+      Fail("Row must have 9 cells", line, tenth_cell_column);
+    else
+      Fail("Row must have 9 cells", line, line_end_column);
+  }
+
+  if (cells > 0)
+    Fail("Board must have 9 rows", line_, 1);
+
+  return false;
+}
+
+// the common case in large collections: exactly 81 cells and a newline,
+// with nothing else on the line
+bool PuzzleParser::ReadPlainLine(Puzzle *puzzle) {
+  const std::size_t kLineLength = 81;
+
+  if (static_cast<std::size_t>(end_ - pos_) <= kLineLength ||
+      pos_[kLineLength] != '\n')
+    return false;
+
+  // a bit is set in bad if any character isn't a cell
+  unsigned bad = 0;
+  for (std::size_t i = 0; i < kLineLength; ++i) {
+    unsigned char c = pos_[i];
+    bool digit = c >= '0' && c <= '9';
+    bool blank = c == '.';
+    bad |= !(digit || blank);
+    (*puzzle)[i] = digit ? c - '0' : 0;
+  }
+
+  if (bad)
+    return false;
+
+  puzzle_line_ = line_;
+  pos_ += kLineLength + 1;
+  ++line_;
+  return true;
+}
+
+std::size_t PuzzleParser::puzzle_line() const {
+  return puzzle_line_;
+}
+
+std::size_t PuzzleParser::line() const {
+  return line_;
+}
+
+const char *PuzzleParser::pos() const {
+  return pos_;
+}
+
+std::size_t PuzzleParser::CountCells(const char *begin) const {
+  std::size_t cells = 0;
+  for (const char *pos = begin; pos < end_ && *pos != '\n' && *pos != '#';
+       ++pos) {
+    char c = *pos;
+    if ((c >= '0' && c <= '9') || c == '.' || c == '*' || c == '_')
+      ++cells;
+  }
+
+  return cells;
+}
+
+void PuzzleParser::SkipRows(std::size_t rows) {
+  while (rows > 0 && pos_ < end_) {
+    const char *line_end = pos_;
+    bool blank = true;
+    for (; line_end < end_ && *line_end != '\n'; ++line_end)
+      blank = blank && (*line_end == ' ' || *line_end == '\t' ||
+                        *line_end == '\r');
+
+    bool header = line_end - pos_ >= 2 && pos_[0] == '#' && pos_[1] == '!';
+    std::size_t cells = CountCells(pos_);
+    if (blank || header || cells > kMaxRowCells)
+      return;
+
+    if (cells > 0)
+      --rows;
+
+    pos_ = line_end < end_ ? line_end + 1 : line_end;
+    ++line_;
+  }
+}
+
+// leave the parser at the start of the next puzzle, so that it can carry
+// on; otherwise the rest of a broken grid would be read as the start of
+// the next one, and throw every puzzle after it out of step
+void PuzzleParser::Fail(const std::string& message, std::size_t line,
+                        std::size_t column) {
+  // the failing line may already have been read
+  bool failing_line_read = line != line_;
+
+  if (!failing_line_read) {
+    while (pos_ < end_ && *pos_ != '\n')
+      ++pos_;
+    if (pos_ < end_)
+      ++pos_;
+    ++line_;
+  }
+
+  // a grid row, or a grid that ended early at a line with a whole puzzle,
+  // which the next call reads
+  std::size_t cells = CountCells(line_start_);
+  if (cells > 0 && cells <= kMaxRowCells && grid_rows_ < 8)
+    SkipRows(8 - grid_rows_);
+
+  throw ParseError(message, line, column);
+}
@@ -0,0 +1,81 @@
+#ifndef PUZZLE_PARSER_H_
+#define PUZZLE_PARSER_H_
+
+#include <array>
+#include <cstddef>  // for std::size_t
+#include <stdexcept>  // for std::invalid_argument
+#include <string>
+
+// reads puzzles out of text without allocating, in any of these layouts:
+//
+//   81 cells on one line, one puzzle per line
+//   9 lines of 9 cells, with or without spaces between them
+//   .sdk and .ss grids, with | and ---+---+--- box separators
+//
+// Blank cells are 0, '.', '*' or '_'. Anything after a '#' is a comment.
+// One text can hold many puzzles in any mix of these layouts.
+class PuzzleParser {
+ public:
+  // clues in row order, with 0 for blank cells
+  using Puzzle = std::array<int, 81>;
+
+  class ParseError : public std::invalid_argument {
+   public:
+    ParseError(const std::string& message, std::size_t line,
+               std::size_t column);
+
+    std::size_t line() const;
+    std::size_t column() const;
+
+   private:
+    std::size_t line_;
+    std::size_t column_;
+  };
+
+  // the text must outlive the parser
+  PuzzleParser(const char *begin, const char *end);
+
+  // starts in the middle of a text, at the beginning of the given line
+  PuzzleParser(const char *begin, const char *end, std::size_t line);
+
+  // returns false once there are no puzzles left; after a ParseError, the
+  // next call carries on from the next puzzle, skipping what's left of a
+  // broken grid
+  bool Next(Puzzle *puzzle);
+
+  // the line the last puzzle returned by Next started on
+  std::size_t puzzle_line() const;
+
+  // the line Next will read next
+  std::size_t line() const;
+
+  // where in the text Next will read next
+  const char *pos() const;
+
+ private:
+  // too many cells for a row of a grid, so probably a whole puzzle
+  static const std::size_t kMaxRowCells = 18;
+
+  bool ReadPlainLine(Puzzle *puzzle);
+
+  // the cells on the line that starts at begin
+  std::size_t CountCells(const char *begin) const;
+
+  // skips lines until rows more rows of a grid have gone by, stopping
+  // early at a blank line, a "#!" line, or a line with a whole puzzle
+  void SkipRows(std::size_t rows);
+
+  [[noreturn]] void Fail(const std::string& message, std::size_t line,
+                         std::size_t column);
+
+  const char *pos_;
+  const char *end_;
+  std::size_t line_;
+  std::size_t puzzle_line_;
+  // where the line being read starts, and how many rows of a grid came
+  // before it, for Fail to skip the rest of the grid
+  const char *line_start_;
+  std::size_t grid_rows_;
+};
+
+#endif
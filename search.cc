@@ -0,0 +1,419 @@
+#include <algorithm>  // for std::copy, std::max, std::stable_sort
+#include <stdexcept>  // for std::logic_error
+
+#include "operators.h"
+#include "search.h"
+
+Search::Search() : budget_(nullptr), cancelled_(false) {
+  InitializeUnits(Layout::Standard());
+}
+
+Search::Search(const Options& options)
+    : options_(options), budget_(nullptr), cancelled_(false) {
+  InitializeUnits(Layout::Standard());
+}
+
+void Search::set_budget(Budget *budget) {
+  budget_ = budget;
+}
+
+Search::SearchResult Search::Solve(const Board& board) {
+  stats_ = Stats();
+  cancelled_ = false;
+  nogoods_.clear();
+  trail_.Clear();
+
+  if (board.shared_layout() != layout_)
+    InitializeUnits(board.shared_layout());
+
+  State& root = state_;
+  root.board = board;
+
+  try {
+    Operators::FillInGuesses(root.board);
+  } catch (const std::logic_error&) {
+    // some cell already has no possible guesses
+    return SearchResult::Unsolvable(board, stats_);
+  }
+
+  for (std::size_t i = 0; i < kCells; ++i) {
+    root.elimination_reasons[i].fill(LevelSet());
+    root.placement_reasons[i].reset();
+    root.propagated[i] = false;
+  }
+
+  root.board.set_trail(&trail_);
+
+  LevelSet conflict;
+  if (!Propagate(root, &conflict))
+    return SearchResult::Unsolvable(board, stats_);
+
+  if (Descend(1, &conflict))
+    return SearchResult::Solved(solution_, stats_);
+
+  if (cancelled_)
+    return SearchResult::Cancelled(board, stats_);
+
+  return SearchResult::Unsolvable(board, stats_);
+}
+
+Cell *Search::CellAt(Board& board, std::size_t index) {
+  return board.cell(index / 9 + 1, index % 9 + 1);
+}
+
+void Search::InitializeUnits(const std::shared_ptr<const Layout>& layout) {
+  layout_ = layout;
+  units_.clear();
+  cages_.clear();
+
+  for (const Layout::Unit& layout_unit : layout->units()) {
+    if (layout_unit.complete()) {
+      Unit unit;
+      std::copy(layout_unit.cells.cbegin(), layout_unit.cells.cend(),
+                unit.begin());
+      units_.push_back(unit);
+    }
+
+    if (layout_unit.sum > 0)
+      cages_.push_back({layout_unit.cells, layout_unit.sum});
+  }
+
+  for (std::size_t i = 0; i < kCells; ++i)
+    peers_[i] = layout->peers(i);
+}
+
+// Returns true once a solution is found. Otherwise, unless the budget ran
+// out, *conflict holds the levels before this one that together make this
+// branch impossible.
+bool Search::Descend(std::size_t level, LevelSet *conflict) {
+  State& state = state_;
+
+  std::size_t branch_cell = ChooseCell(state);
+  if (branch_cell == kCells) {
+    solution_ = state.board;
+    return true;
+  }
+
+  stats_.max_depth = std::max(stats_.max_depth, level);
+
+  Cell::CellGuesses guesses = CellAt(state.board, branch_cell)->guesses();
+
+  // the digits that are already gone from this cell fail for their own
+  // reasons
+  LevelSet level_conflict;
+  for (int digit = 1; digit <= 9; ++digit) {
+    if (guesses.count(digit) == 0)
+      level_conflict |= state.elimination_reasons[branch_cell][digit];
+  }
+
+  Trail::Mark mark = trail_.mark();
+
+  for (int digit : guesses) {
+    if (budget_ && budget_->Exhausted(0, stats_.nodes)) {
+      cancelled_ = true;
+      return false;
+    }
+
+    ++stats_.nodes;
+
+    state.decisions[level] = {branch_cell, digit};
+
+    LevelSet reason;
+    reason.set(level);
+    Place(state, branch_cell, digit, reason);
+
+    LevelSet child_conflict;
+    if (Propagate(state, &child_conflict) &&
+        Descend(level + 1, &child_conflict))
+      return true;
+
+    if (cancelled_)
+      return false;
+
+    ++stats_.backtracks;
+    trail_.Undo(mark);
+
+    if (options_.learn_nogoods)
+      Learn(state, child_conflict);
+
+    // this decision had nothing to do with the failure, so neither will
+    // any of its siblings
+    if (options_.backjump && !child_conflict.test(level)) {
+      ++stats_.backjumps;
+      *conflict = child_conflict;
+      return false;
+    }
+
+    child_conflict.reset(level);
+    level_conflict |= child_conflict;
+  }
+
+  *conflict = level_conflict;
+  return false;
+}
+
+// the unsolved cell with the fewest guesses, or kCells if all are solved
+std::size_t Search::ChooseCell(State& state) const {
+  std::size_t best_cell = kCells;
+  std::size_t best_count = 10;
+
+  for (std::size_t i = 0; i < kCells; ++i) {
+    const Cell *cell = CellAt(state.board, i);
+    if (cell->solved())
+      continue;
+
+    std::size_t count = cell->guesses().size();
+    if (count < best_count) {
+      best_cell = i;
+      best_count = count;
+      if (count <= 2)
+        break;
+    }
+  }
+
+  return best_cell;
+}
+
+bool Search::Propagate(State& state, LevelSet *conflict) {
+  bool changed = true;
+  while (changed) {
+    changed = false;
+
+    if (!PropagatePlacements(state, conflict))
+      return false;
+
+    PropagateNakedSingles(state, &changed);
+    if (changed)
+      continue;
+
+    if (!PropagateHiddenSingles(state, conflict, &changed))
+      return false;
+    if (changed)
+      continue;
+
+    if (!PropagateCages(state, conflict))
+      return false;
+
+    if (options_.learn_nogoods &&
+        !PropagateNogoods(state, conflict, &changed))
+      return false;
+  }
+
+  return true;
+}
+
+// remove each new solution from the guesses of its peers
+bool Search::PropagatePlacements(State& state, LevelSet *conflict) {
+  for (std::size_t i = 0; i < kCells; ++i) {
+    const Cell *cell = CellAt(state.board, i);
+    if (!cell->solved() || state.propagated[i])
+      continue;
+
+    state.propagated[i] = true;
+    int digit = cell->solution();
+    const LevelSet& reason = state.placement_reasons[i];
+
+    for (std::size_t peer : peers_[i]) {
+      const Cell *peer_cell = CellAt(state.board, peer);
+      if (peer_cell->solved()) {
+        if (peer_cell->solution() == digit) {
+          *conflict = reason | state.placement_reasons[peer];
+          return false;
+        }
+      } else if (peer_cell->has_guess(digit)) {
+        if (!Eliminate(state, peer, digit, reason, conflict))
+          return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+// cells left without guesses are caught by Eliminate
+void Search::PropagateNakedSingles(State& state, bool *changed) {
+  for (std::size_t i = 0; i < kCells; ++i) {
+    const Cell *cell = CellAt(state.board, i);
+    if (cell->solved() || cell->guesses().size() != 1)
+      continue;
+
+    int digit = *cell->guesses().cbegin();
+    LevelSet reason;
+    for (int other = 1; other <= 9; ++other) {
+      if (other != digit)
+        reason |= state.elimination_reasons[i][other];
+    }
+
+    Place(state, i, digit, reason);
+    *changed = true;
+  }
+}
+
+bool Search::PropagateHiddenSingles(State& state, LevelSet *conflict,
+                                    bool *changed) {
+  for (const Unit& unit : units_) {
+    for (int digit = 1; digit <= 9; ++digit) {
+      LevelSet reason;
+      std::size_t count = 0;
+      std::size_t only_cell = kCells;
+      bool placed = false;
+
+      for (std::size_t i : unit) {
+        const Cell *cell = CellAt(state.board, i);
+        if (cell->solved()) {
+          if (cell->solution() == digit) {
+            placed = true;
+            break;
+          }
+          reason |= state.placement_reasons[i];
+        } else if (cell->has_guess(digit)) {
+          ++count;
+          only_cell = i;
+        } else {
+          reason |= state.elimination_reasons[i][digit];
+        }
+      }
+
+      if (placed || count > 1)
+        continue;
+
+      if (count == 0) {
+        // nowhere left for this digit in this unit
+        *conflict = reason;
+        return false;
+      }
+
+      Place(state, only_cell, digit, reason);
+      *changed = true;
+    }
+  }
+
+  return true;
+}
+
+// a nogood with every literal true is a conflict; with one literal left
+// open, that literal must be false
+bool Search::PropagateNogoods(State& state, LevelSet *conflict,
+                              bool *changed) {
+  for (Nogood& nogood : nogoods_) {
+    LevelSet reason;
+    const Literal *open_literal = nullptr;
+    bool active = true;
+
+    for (const Literal& literal : nogood.literals) {
+      const Cell *cell = CellAt(state.board, literal.cell);
+      if (cell->solved()) {
+        if (cell->solution() != literal.digit) {
+          active = false;
+          break;
+        }
+        reason |= state.placement_reasons[literal.cell];
+      } else if (cell->has_guess(literal.digit) && open_literal == nullptr) {
+        open_literal = &literal;
+      } else {
+        active = false;
+        break;
+      }
+    }
+
+    if (!active)
+      continue;
+
+    nogood.last_used = stats_.nodes;
+    ++stats_.nogood_prunes;
+
+    if (open_literal == nullptr) {
+      *conflict = reason;
+      return false;
+    }
+
+    if (!Eliminate(state, open_literal->cell, open_literal->digit, reason,
+                   conflict))
+      return false;
+    *changed = true;
+  }
+
+  return true;
+}
+
+// a cage whose solved cells already add up to too much, or that is full and
+// adds up to the wrong sum, is a conflict
+bool Search::PropagateCages(State& state, LevelSet *conflict) {
+  for (const Cage& cage : cages_) {
+    LevelSet reason;
+    int sum = 0;
+    bool filled = true;
+
+    for (std::size_t i : cage.cells) {
+      const Cell *cell = CellAt(state.board, i);
+      if (cell->solved()) {
+        sum += cell->solution();
+        reason |= state.placement_reasons[i];
+      } else {
+        filled = false;
+      }
+    }
+
+    if (sum > cage.sum || (filled && sum != cage.sum)) {
+      *conflict = reason;
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void Search::Place(State& state, std::size_t index, int digit,
+                   const LevelSet& reason) {
+  state.board.SetSolution(CellAt(state.board, index), digit);
+  state.placement_reasons[index] = reason;
+  state.propagated[index] = false;
+}
+
+bool Search::Eliminate(State& state, std::size_t index, int digit,
+                       const LevelSet& reason, LevelSet *conflict) {
+  Cell *cell = CellAt(state.board, index);
+  state.board.RemoveGuess(cell, digit);
+  state.elimination_reasons[index][digit] = reason;
+
+  if (cell->guesses().empty()) {
+    conflict->reset();
+    for (int other = 1; other <= 9; ++other)
+      *conflict |= state.elimination_reasons[index][other];
+    return false;
+  }
+
+  return true;
+}
+
+// the decisions at the levels in conflict can never all be made together
+void Search::Learn(const State& state, const LevelSet& conflict) {
+  std::size_t size = conflict.count();
+  if (size == 0 || size > options_.max_nogood_size)
+    return;
+
+  Nogood nogood;
+  nogood.last_used = stats_.nodes;
+  for (std::size_t level = 1; level <= kCells; ++level) {
+    if (conflict.test(level))
+      nogood.literals.push_back(state.decisions[level]);
+  }
+
+  nogoods_.push_back(nogood);
+  ++stats_.nogoods_learned;
+
+  if (nogoods_.size() > options_.max_nogoods)
+    Forget();
+}
+
+// keep the most recently used half of the store
+void Search::Forget() {
+  std::stable_sort(nogoods_.begin(), nogoods_.end(),
+                   [](const Nogood& a, const Nogood& b) {
+                     return a.last_used > b.last_used;
+                   });
+
+  std::size_t keep = options_.max_nogoods / 2;
+  stats_.nogoods_forgotten += nogoods_.size() - keep;
+  nogoods_.resize(keep);
+}
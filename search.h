@@ -0,0 +1,169 @@
+#ifndef SEARCH_H_
+#define SEARCH_H_
+
+#include <array>
+#include <bitset>
+#include <cstddef>  // for std::size_t
+#include <cstdint>  // for std::uint64_t
+#include <memory>  // for std::shared_ptr
+#include <vector>
+
+#include "board.h"
+#include "budget.h"
+#include "trail.h"
+
+// depth-first search for boards that the operators can't finish on their own
+//
+// The search works on a single board and undoes each branch through a trail,
+// so memory use doesn't grow with depth. Every placement and elimination
+// remembers which decision levels it depends on. When a branch fails,
+// those levels explain the failure: the search jumps straight back to the
+// most recent level involved, and the decisions at those levels are stored
+// as a nogood that is never tried again.
+class Search {
+ public:
+  struct Options {
+    // go back to the latest decision that caused a failure instead of the
+    // previous one
+    bool backjump = true;
+
+    // remember failed combinations of decisions and prune with them
+    bool learn_nogoods = true;
+
+    // once the store holds more than max_nogoods, the least recently used
+    // half of it is forgotten
+    std::size_t max_nogoods = 2000;
+
+    // longer explanations are too specific to be worth storing
+    std::size_t max_nogood_size = 12;
+
+    // chronological backtracking with no learning
+    static Options Plain() {
+      Options options;
+      options.backjump = false;
+      options.learn_nogoods = false;
+      return options;
+    }
+  };
+
+  struct Stats {
+    std::uint64_t nodes = 0;
+    std::uint64_t backtracks = 0;
+    std::uint64_t backjumps = 0;
+    std::uint64_t nogoods_learned = 0;
+    std::uint64_t nogoods_forgotten = 0;
+    std::uint64_t nogood_prunes = 0;
+    std::size_t max_depth = 0;
+  };
+
+  struct SearchResult {
+    bool solved;
+    bool cancelled;
+    Board board;
+    Stats stats;
+
+    static SearchResult Solved(const Board& board, const Stats& stats) {
+      return SearchResult(true, false, board, stats);
+    }
+
+    static SearchResult Unsolvable(const Board& board, const Stats& stats) {
+      return SearchResult(false, false, board, stats);
+    }
+
+    // the budget ran out before the search finished
+    static SearchResult Cancelled(const Board& board, const Stats& stats) {
+      return SearchResult(false, true, board, stats);
+    }
+
+   private:
+    SearchResult(bool solved, bool cancelled, const Board& board,
+                 const Stats& stats)
+        : solved(solved), cancelled(cancelled), board(board), stats(stats) {}
+  };
+
+  Search();
+  explicit Search(const Options& options);
+
+  // the budget is checked before each node; nullptr means no limits
+  void set_budget(Budget *budget);
+
+  SearchResult Solve(const Board& board);
+
+ private:
+  static const std::size_t kCells = 81;
+
+  // bit n is set if decision level n is involved; there can't be more
+  // decisions than cells
+  using LevelSet = std::bitset<kCells + 1>;
+  using Unit = std::array<std::size_t, 9>;
+
+  // "cell is solved with digit"; cells are numbered 0 to 80 in row order
+  struct Literal {
+    std::size_t cell;
+    int digit;
+  };
+
+  struct Nogood {
+    std::vector<Literal> literals;
+    std::uint64_t last_used;
+  };
+
+  // Reasons are only read for guesses that are gone and cells that are
+  // solved, and those can't change again until the trail undoes them, so
+  // the reasons themselves never need undoing.
+  struct State {
+    Board board;
+    std::array<std::array<LevelSet, 10>, kCells> elimination_reasons;
+    std::array<LevelSet, kCells> placement_reasons;
+    std::array<bool, kCells> propagated;
+    std::array<Literal, kCells + 1> decisions;
+  };
+
+  // a cage of a killer layout: its digits must add up to sum
+  struct Cage {
+    std::vector<std::size_t> cells;
+    int sum;
+  };
+
+  static Cell *CellAt(Board& board, std::size_t index);
+
+  void InitializeUnits(const std::shared_ptr<const Layout>& layout);
+
+  bool Descend(std::size_t level, LevelSet *conflict);
+  std::size_t ChooseCell(State& state) const;
+
+  bool Propagate(State& state, LevelSet *conflict);
+  bool PropagatePlacements(State& state, LevelSet *conflict);
+  void PropagateNakedSingles(State& state, bool *changed);
+  bool PropagateHiddenSingles(State& state, LevelSet *conflict,
+                              bool *changed);
+  bool PropagateNogoods(State& state, LevelSet *conflict, bool *changed);
+  bool PropagateCages(State& state, LevelSet *conflict);
+
+  void Place(State& state, std::size_t index, int digit,
+             const LevelSet& reason);
+  bool Eliminate(State& state, std::size_t index, int digit,
+                 const LevelSet& reason, LevelSet *conflict);
+
+  void Learn(const State& state, const LevelSet& conflict);
+  void Forget();
+
+  Options options_;
+  Stats stats_;
+
+  Budget *budget_;
+  bool cancelled_;
+
+  // built from this layout; only units that hold every digit are here
+  std::shared_ptr<const Layout> layout_;
+  std::vector<Unit> units_;
+  std::vector<Cage> cages_;
+  std::array<std::vector<std::size_t>, kCells> peers_;
+
+  State state_;
+  Trail trail_;
+  std::vector<Nogood> nogoods_;
+  Board solution_;
+};
+
+#endif
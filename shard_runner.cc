@@ -0,0 +1,232 @@
+#include <fcntl.h>  // for O_WRONLY, O_CREAT, O_TRUNC
+#include <spawn.h>  // for posix_spawnp
+#include <sys/stat.h>  // for mkdir
+#include <sys/wait.h>  // for waitpid
+#include <unistd.h>  // for environ
+
+#include <algorithm>  // for std::min
+#include <cerrno>  // for errno, EEXIST, EINTR
+#include <cstdio>  // for std::rename
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>  // for std::invalid_argument, std::runtime_error
+
+#include "shard_runner.h"
+
+const char ShardRunner::kManifestHeader[] = "sudoku shards 2";
+
+ShardRunner::ShardRunner(const std::string& directory,
+                         const std::vector<std::string>& command)
+    : directory_(directory), command_(command), partial_line_(false) {
+  if (mkdir(directory_.c_str(), 0777) != 0 && errno != EEXIST)
+    throw std::runtime_error("Couldn't create " + directory_);
+
+  ReadManifest();
+}
+
+bool ShardRunner::planned() const {
+  return !shards_.empty();
+}
+
+void ShardRunner::Plan(std::uint64_t puzzles, std::uint64_t shard_size,
+                       const std::vector<Start>& starts) {
+  if (shard_size == 0)
+    throw std::invalid_argument("Shard size must be at least 1");
+
+  shards_.clear();
+  for (std::uint64_t first = 0; first < puzzles; first += shard_size) {
+    std::uint64_t count = std::min(shard_size, puzzles - first);
+    shards_.push_back({shards_.size(), first, count,
+                       starts.at(shards_.size())});
+  }
+
+  // an empty corpus still gets one shard, so that it is planned
+  if (shards_.empty())
+    shards_.push_back({0, 0, 0, {0, 0, 1}});
+
+  done_.assign(shards_.size(), false);
+  partial_line_ = false;
+
+  // written whole and then renamed, so a crash never leaves half a plan
+  std::string temp_filename = ManifestFilename() + ".tmp";
+  {
+    std::ofstream fs(temp_filename, std::ofstream::trunc);
+    fs << kManifestHeader << '\n' << "command";
+    for (const std::string& arg : command_)
+      fs << '\t' << arg;
+    fs << '\n';
+
+    for (const Shard& shard : shards_)
+      fs << "shard " << shard.number << ' ' << shard.first << ' '
+         << shard.count << ' ' << shard.start.file << ' '
+         << shard.start.offset << ' ' << shard.start.position << '\n';
+
+    if (!fs.flush())
+      throw std::runtime_error("Couldn't write " + temp_filename);
+  }
+
+  if (std::rename(temp_filename.c_str(), ManifestFilename().c_str()) != 0)
+    throw std::runtime_error("Couldn't write " + ManifestFilename());
+}
+
+const std::vector<ShardRunner::Shard>& ShardRunner::shards() const {
+  return shards_;
+}
+
+bool ShardRunner::done(const Shard& shard) const {
+  return done_[shard.number];
+}
+
+std::string ShardRunner::OutputFilename(const Shard& shard) const {
+  return directory_ + "/shard-" + std::to_string(shard.number) + ".out";
+}
+
+std::size_t ShardRunner::Run(const std::string& program, unsigned workers,
+                             int max_ok_status) {
+  std::map<int, std::size_t> running;  // shard number by process id
+  std::size_t next = 0;
+  std::size_t failed = 0;
+
+  while (true) {
+    while (running.size() < workers && next < shards_.size()) {
+      const Shard& shard = shards_[next++];
+      if (!done_[shard.number])
+        running[Spawn(program, shard)] = shard.number;
+    }
+
+    if (running.empty())
+      break;
+
+    int status;
+    int pid = waitpid(-1, &status, 0);
+    if (pid < 0) {
+      if (errno == EINTR)
+        continue;
+      throw std::runtime_error("Couldn't wait for workers");
+    }
+
+    auto it = running.find(pid);
+    if (it == running.end())
+      continue;
+
+    const Shard& shard = shards_[it->second];
+    running.erase(it);
+
+    if (!WIFEXITED(status) || WEXITSTATUS(status) > max_ok_status) {
+      ++failed;
+      std::cerr << "Shard " << shard.number << " failed\n";
+      continue;
+    }
+
+    std::string output_filename = OutputFilename(shard);
+    std::string temp_filename = output_filename + ".tmp";
+    if (std::rename(temp_filename.c_str(), output_filename.c_str()) != 0)
+      throw std::runtime_error("Couldn't write " + output_filename);
+
+    AppendManifest("done " + std::to_string(shard.number));
+    done_[shard.number] = true;
+    std::cerr << "Shard " << shard.number << " of " << shards_.size()
+              << " done\n";
+  }
+
+  return failed;
+}
+
+std::string ShardRunner::ManifestFilename() const {
+  return directory_ + "/manifest";
+}
+
+void ShardRunner::ReadManifest() {
+  std::ifstream fs(ManifestFilename());
+  if (!fs.is_open())
+    return;
+
+  std::string line;
+  if (!std::getline(fs, line) || line != kManifestHeader)
+    throw std::invalid_argument(ManifestFilename() + " isn't a manifest");
+
+  std::vector<std::string> command;
+  if (std::getline(fs, line)) {
+    std::istringstream ss(line);
+    std::string arg;
+    std::getline(ss, arg, '\t');
+    while (std::getline(ss, arg, '\t'))
+      command.push_back(arg);
+  }
+
+  if (command != command_)
+    throw std::invalid_argument(directory_ +
+                                " was started with different options");
+
+  // a crash in the middle of appending can leave a partial last line with
+  // no newline; it's skipped, and that shard simply runs again
+  while (std::getline(fs, line)) {
+    if (fs.eof()) {
+      partial_line_ = true;
+      break;
+    }
+
+    std::istringstream ss(line);
+    std::string kind;
+    ss >> kind;
+
+    if (kind == "shard") {
+      Shard shard;
+      ss >> shard.number >> shard.first >> shard.count >> shard.start.file
+         >> shard.start.offset >> shard.start.position;
+      if (!ss || shard.number != shards_.size())
+        throw std::invalid_argument(ManifestFilename() + " is damaged");
+      shards_.push_back(shard);
+      done_.push_back(false);
+    } else if (kind == "done") {
+      std::size_t number;
+      if (ss >> number && number < done_.size())
+        done_[number] = true;
+    }
+  }
+}
+
+void ShardRunner::AppendManifest(const std::string& line) {
+  std::ofstream fs(ManifestFilename(), std::ofstream::app);
+  if (partial_line_)
+    fs << '\n';
+  fs << line << '\n';
+  if (!fs.flush())
+    throw std::runtime_error("Couldn't write " + ManifestFilename());
+
+  partial_line_ = false;
+}
+
+int ShardRunner::Spawn(const std::string& program, const Shard& shard) const {
+  std::vector<std::string> args = {program};
+  args.insert(args.end(), command_.begin(), command_.end());
+  args.push_back("--shard");
+  args.push_back(std::to_string(shard.first));
+  args.push_back(std::to_string(shard.count));
+  args.push_back(std::to_string(shard.start.file));
+  args.push_back(std::to_string(shard.start.offset));
+  args.push_back(std::to_string(shard.start.position));
+
+  std::vector<char *> argv;
+  for (std::string& arg : args)
+    argv.push_back(&arg[0]);
+  argv.push_back(nullptr);
+
+  std::string temp_filename = OutputFilename(shard) + ".tmp";
+  posix_spawn_file_actions_t actions;
+  posix_spawn_file_actions_init(&actions);
+  posix_spawn_file_actions_addopen(&actions, 1, temp_filename.c_str(),
+                                   O_WRONLY | O_CREAT | O_TRUNC, 0666);
+
+  pid_t pid;
+  int error = posix_spawnp(&pid, program.c_str(), &actions, nullptr,
+                           argv.data(), environ);
+  posix_spawn_file_actions_destroy(&actions);
+
+  if (error != 0)
+    throw std::runtime_error("Couldn't start " + program);
+
+  return pid;
+}
@@ -0,0 +1,77 @@
+#ifndef SHARD_RUNNER_H_
+#define SHARD_RUNNER_H_
+
+#include <cstddef>  // for std::size_t
+#include <cstdint>  // for std::uint64_t
+#include <string>
+#include <vector>
+
+// runs a long batch as worker processes, each over one range of puzzles,
+// and keeps a manifest of the finished ranges in a directory so that a run
+// that was stopped or crashed can start again without redoing them
+//
+// Each worker is the program run with the command followed by
+// "--shard FIRST COUNT FILE OFFSET POSITION": its range of puzzles, and
+// where the first of them is, so that it can go straight there instead of
+// reading every puzzle before it. Its standard output goes to the shard's
+// output file, which only appears once the worker has exited normally.
+class ShardRunner {
+ public:
+  // where a shard's first puzzle is
+  struct Start {
+    // which of the files in the command
+    std::size_t file;
+    // bytes into it
+    std::uint64_t offset;
+    // its line, or its record in a snapshot
+    std::uint64_t position;
+  };
+
+  struct Shard {
+    std::size_t number;
+    std::uint64_t first;
+    std::uint64_t count;
+    Start start;
+  };
+
+  // reads the manifest if the directory has one; it must have been started
+  // with the same command
+  ShardRunner(const std::string& directory,
+              const std::vector<std::string>& command);
+
+  // false until Plan has been called by this run or an earlier one
+  bool planned() const;
+
+  // splits the puzzles into ranges of at most shard_size; starts has where
+  // each range begins, that is every shard_size-th puzzle
+  void Plan(std::uint64_t puzzles, std::uint64_t shard_size,
+            const std::vector<Start>& starts);
+
+  const std::vector<Shard>& shards() const;
+  bool done(const Shard& shard) const;
+  std::string OutputFilename(const Shard& shard) const;
+
+  // runs every unfinished shard, up to workers at a time, and returns the
+  // number of workers that failed; exit statuses up to max_ok_status count
+  // as finished
+  std::size_t Run(const std::string& program, unsigned workers,
+                  int max_ok_status);
+
+ private:
+  static const char kManifestHeader[];
+
+  std::string ManifestFilename() const;
+  void ReadManifest();
+  void AppendManifest(const std::string& line);
+
+  int Spawn(const std::string& program, const Shard& shard) const;
+
+  std::string directory_;
+  std::vector<std::string> command_;
+  std::vector<Shard> shards_;
+  std::vector<bool> done_;
+  // the manifest ends in the middle of a line
+  bool partial_line_;
+};
+
+#endif
@@ -0,0 +1,207 @@
+#include <algorithm>  // for std::equal
+#include <stdexcept>  // for std::invalid_argument, std::runtime_error
+
+#include "operators.h"
+#include "solve_trace.h"
+
+const char SolveTrace::kMagic[] = {'S', 'D', 'K', 'T'};
+
+const std::string SolveTrace::kSearchTechnique = "Search";
+
+SolveTrace::Writer::Writer(const std::string& filename, const Board& board)
+    : filename_(filename),
+      fs_(filename, std::ofstream::out | std::ofstream::binary),
+      search_technique_(Operators::Techniques().size()), steps_(0) {
+  if (!fs_.is_open())
+    throw std::runtime_error("Couldn't write " + filename_);
+
+  fs_.write(kMagic, sizeof(kMagic));
+  fs_.put(kVersion);
+
+  std::vector<std::string> names;
+  for (const auto& technique : Operators::Techniques())
+    names.push_back(technique.name);
+  names.push_back(kSearchTechnique);
+
+  fs_.put(static_cast<char>(names.size()));
+  for (const std::string& name : names) {
+    fs_.put(static_cast<char>(name.size()));
+    fs_.write(name.data(), name.size());
+  }
+
+  std::string layout = board.layout().ToText();
+  if (layout.size() > 0xffff)
+    throw std::invalid_argument("Layout is too big for a solve trace");
+  fs_.put(static_cast<char>(layout.size() & 0xff));
+  fs_.put(static_cast<char>(layout.size() >> 8));
+  fs_.write(layout.data(), layout.size());
+
+  char record[Board::kSnapshotRecordSize];
+  char *out = record;
+  for (std::size_t i = 0; i < 81; ++i) {
+    words_[i] = Board::SnapshotWord(*board.cell(i / 9 + 1, i % 9 + 1));
+    *out++ = static_cast<char>(words_[i] & 0xff);
+    *out++ = static_cast<char>(words_[i] >> 8);
+  }
+  fs_.write(record, sizeof(record));
+}
+
+void SolveTrace::Writer::Record(std::size_t technique, const Board& board,
+                                const std::set<const Cell *>& highlighted) {
+  WriteStep(technique, board, &highlighted);
+}
+
+void SolveTrace::Writer::RecordSearch(const Board& board) {
+  WriteStep(search_technique_, board, nullptr);
+}
+
+std::uint64_t SolveTrace::Writer::steps() const {
+  return steps_;
+}
+
+void SolveTrace::Writer::Close() {
+  fs_.close();
+  if (!fs_)
+    throw std::runtime_error("Couldn't write " + filename_);
+}
+
+void SolveTrace::Writer::WriteStep(std::size_t technique, const Board& board,
+                                   const std::set<const Cell *> *highlighted) {
+  // a step changes at most every cell once, so this is always enough
+  char record[2 + 81 * 3];
+  char *out = record + 2;
+
+  for (std::size_t i = 0; i < 81; ++i) {
+    const Cell *cell = board.cell(i / 9 + 1, i % 9 + 1);
+    std::uint16_t word = Board::SnapshotWord(*cell);
+    if (word == words_[i])
+      continue;
+
+    words_[i] = word;
+    bool highlight = !highlighted || highlighted->count(cell) > 0;
+    *out++ = static_cast<char>(i | (highlight ? kHighlighted : 0));
+    *out++ = static_cast<char>(word & 0xff);
+    *out++ = static_cast<char>(word >> 8);
+  }
+
+  record[0] = static_cast<char>(technique);
+  record[1] = static_cast<char>((out - record - 2) / 3);
+  fs_.write(record, out - record);
+  ++steps_;
+}
+
+SolveTrace::Reader::Reader(const std::string& filename)
+    : file_(filename),
+      pos_(reinterpret_cast<const unsigned char *>(file_.begin())),
+      end_(reinterpret_cast<const unsigned char *>(file_.end())) {
+  if (file_.size() < sizeof(kMagic) + 2 ||
+      !std::equal(kMagic, kMagic + sizeof(kMagic), file_.begin()))
+    throw std::invalid_argument("Not a solve trace");
+
+  pos_ += sizeof(kMagic);
+  char version = *Take(1);
+  if (version != 1 && version != kVersion)
+    throw std::invalid_argument("Unsupported solve trace version");
+
+  std::size_t count = *Take(1);
+  for (std::size_t i = 0; i < count; ++i) {
+    std::size_t length = *Take(1);
+    const char *name = reinterpret_cast<const char *>(Take(length));
+    techniques_.emplace_back(name, length);
+  }
+
+  layout_ = Layout::Standard();
+  if (version != 1) {
+    const unsigned char *in = Take(2);
+    std::size_t length = in[0] | (in[1] << 8);
+    const char *text = reinterpret_cast<const char *>(Take(length));
+    layout_ = Layout::FromText(text, text + length);
+  }
+
+  start_ = pos_;
+  Restart();
+}
+
+const Board& SolveTrace::Reader::board() const {
+  return board_;
+}
+
+std::uint64_t SolveTrace::Reader::step() const {
+  return step_;
+}
+
+const std::string& SolveTrace::Reader::technique() const {
+  return technique_;
+}
+
+const std::set<const Cell *>& SolveTrace::Reader::cells_changed() const {
+  return cells_changed_;
+}
+
+bool SolveTrace::Reader::Next() {
+  if (pos_ == end_)
+    return false;
+
+  std::size_t technique = *Take(1);
+  if (technique >= techniques_.size())
+    throw std::invalid_argument("Step " + std::to_string(step_ + 1) +
+                                " of solve trace has an unknown technique");
+
+  std::size_t count = *Take(1);
+  const unsigned char *in = Take(count * 3);
+
+  cells_changed_.clear();
+  for (std::size_t i = 0; i < count; ++i, in += 3) {
+    std::size_t index = in[0] & ~kHighlighted;
+    if (index >= 81)
+      throw std::invalid_argument("Step " + std::to_string(step_ + 1) +
+                                  " of solve trace has an invalid cell");
+
+    Cell *cell = board_.cell(index / 9 + 1, index % 9 + 1);
+    board_.SetFromSnapshotWord(cell, in[1] | (in[2] << 8));
+    if (in[0] & kHighlighted)
+      cells_changed_.insert(cell);
+  }
+
+  technique_ = techniques_[technique];
+  ++step_;
+  return true;
+}
+
+bool SolveTrace::Reader::Seek(std::uint64_t step) {
+  if (step < step_)
+    Restart();
+
+  while (step_ < step) {
+    if (!Next())
+      return false;
+  }
+
+  return true;
+}
+
+void SolveTrace::Reader::Restart() {
+  pos_ = start_;
+  const unsigned char *in = Take(Board::kSnapshotRecordSize);
+
+  Board board;
+  board.set_layout(layout_);
+  for (std::size_t i = 1; i <= 9; ++i) {
+    for (std::size_t j = 1; j <= 9; ++j, in += 2)
+      board.SetFromSnapshotWord(board.cell(i, j), in[0] | (in[1] << 8));
+  }
+
+  board_ = board;
+  step_ = 0;
+  technique_.clear();
+  cells_changed_.clear();
+}
+
+const unsigned char *SolveTrace::Reader::Take(std::size_t count) {
+  if (static_cast<std::size_t>(end_ - pos_) < count)
+    throw std::invalid_argument("Solve trace is truncated");
+
+  const unsigned char *result = pos_;
+  pos_ += count;
+  return result;
+}
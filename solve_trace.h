@@ -0,0 +1,120 @@
+#ifndef SOLVE_TRACE_H_
+#define SOLVE_TRACE_H_
+
+#include <array>
+#include <cstddef>  // for std::size_t
+#include <cstdint>  // for std::uint16_t, std::uint64_t
+#include <fstream>
+#include <memory>  // for std::shared_ptr
+#include <set>
+#include <string>
+#include <vector>
+
+#include "board.h"
+#include "mapped_file.h"
+
+// a compact binary record of each step of a solve, so that any point of it
+// can be shown again later without solving the puzzle a second time
+//
+// A trace is a header, the starting board, and then one record per step:
+//
+//   header  "SDKT", a version byte, the number of techniques, each
+//           technique's name as a length byte followed by its characters,
+//           and the layout's "#!" lines as in a snapshot header (not in
+//           version 1, whose boards are all standard)
+//   board   81 little-endian 16-bit words in row order, as in a snapshot
+//   step    the technique's index into the header's names, the number of
+//           cells changed, and for each one its index in row order, with
+//           the top bit set if the step highlighted it, and its new word
+//
+// Only the cells a step changed are stored, so a step is usually a few
+// dozen bytes, and the technique names make a trace readable by a build
+// whose operators are in a different order.
+class SolveTrace {
+ public:
+  class Writer {
+   public:
+    // writes the header and the board the solve starts from
+    Writer(const std::string& filename, const Board& board);
+
+    Writer(const Writer&) = delete;
+    Writer& operator=(const Writer&) = delete;
+
+    // a step made by the operator at this index into
+    // Operators::Techniques(), given the board after it; every cell that
+    // changed is stored, not just the highlighted ones
+    void Record(std::size_t technique, const Board& board,
+                const std::set<const Cell *>& highlighted);
+
+    // a search that solved the board
+    void RecordSearch(const Board& board);
+
+    std::uint64_t steps() const;
+
+    // throws if anything couldn't be written
+    void Close();
+
+   private:
+    // highlights every changed cell if highlighted is null
+    void WriteStep(std::size_t technique, const Board& board,
+                   const std::set<const Cell *> *highlighted);
+
+    std::string filename_;
+    std::ofstream fs_;
+    std::size_t search_technique_;
+    // each cell's word as of the last step, to find the ones that changed
+    std::array<std::uint16_t, 81> words_;
+    std::uint64_t steps_;
+  };
+
+  class Reader {
+   public:
+    // reads the header and the starting board; throws if the file isn't a
+    // trace
+    explicit Reader(const std::string& filename);
+
+    // the board as of step()
+    const Board& board() const;
+    // how many steps have been applied to the starting board
+    std::uint64_t step() const;
+    // the technique and highlighted cells of the last step applied; empty
+    // at step 0
+    const std::string& technique() const;
+    const std::set<const Cell *>& cells_changed() const;
+
+    // applies the next step; returns false at the end of the trace
+    bool Next();
+
+    // goes forward, or back to the start and then forward, to the step;
+    // returns false, stopping at the last step, if the trace is shorter
+    bool Seek(std::uint64_t step);
+
+   private:
+    void Restart();
+    // throws if fewer than count bytes are left
+    const unsigned char *Take(std::size_t count);
+
+    MappedFile file_;
+    std::vector<std::string> techniques_;
+    std::shared_ptr<const Layout> layout_;
+    // where the starting board's record begins
+    const unsigned char *start_;
+    const unsigned char *pos_;
+    const unsigned char *end_;
+
+    Board board_;
+    std::uint64_t step_;
+    std::string technique_;
+    std::set<const Cell *> cells_changed_;
+  };
+
+ private:
+  SolveTrace() {}  // prevent instantiating this class
+
+  static const char kMagic[4];
+  static const char kVersion = 2;
+  static const std::string kSearchTechnique;
+  static const unsigned char kHighlighted = 0x80;
+};
+
+#endif
@@ -0,0 +1,81 @@
+#include "step_pipeline.h"
+
+StepPipeline::StepPipeline(const Game& game, std::size_t capacity)
+    : game_(game), capacity_(capacity > 0 ? capacity : 1),
+      stopping_(false) {
+  // started last, once everything it uses is ready
+  producer_ = std::thread(&StepPipeline::Produce, this);
+}
+
+StepPipeline::~StepPipeline() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  changed_.notify_all();
+  producer_.join();
+}
+
+std::shared_ptr<const StepPipeline::Frame> StepPipeline::Next() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  changed_.wait(lock, [this]() {
+    return !frames_.empty() || error_ || last_frame_;
+  });
+
+  if (frames_.empty()) {
+    if (error_)
+      std::rethrow_exception(error_);
+    return last_frame_;
+  }
+
+  auto frame = frames_.front();
+  frames_.pop_front();
+  changed_.notify_all();
+
+  return frame;
+}
+
+void StepPipeline::Produce() {
+  try {
+    while (true) {
+      auto result = game_.Step();
+
+      auto frame = std::make_shared<Frame>();
+      frame->board = game_.board();
+      // point at the frame's own copy of the cells, not the game's
+      for (const Cell *cell : result.cells_changed)
+        frame->cells_changed.insert(frame->board.cell(cell->row(),
+                                                      cell->col()));
+      frame->change_descriptions = result.change_descriptions;
+      frame->done = result.done;
+
+      if (result.done) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        last_frame_ = frame;
+        changed_.notify_all();
+        return;
+      }
+
+      if (!Push(frame))
+        return;
+    }
+  } catch (...) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    error_ = std::current_exception();
+    changed_.notify_all();
+  }
+}
+
+bool StepPipeline::Push(std::shared_ptr<const Frame> frame) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  changed_.wait(lock, [this]() {
+    return frames_.size() < capacity_ || stopping_;
+  });
+
+  if (stopping_)
+    return false;
+
+  frames_.push_back(frame);
+  changed_.notify_all();
+  return true;
+}
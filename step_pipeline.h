@@ -0,0 +1,64 @@
+#ifndef STEP_PIPELINE_H_
+#define STEP_PIPELINE_H_
+
+#include <condition_variable>
+#include <cstddef>  // for std::size_t
+#include <deque>
+#include <exception>  // for std::exception_ptr
+#include <memory>  // for std::shared_ptr
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "game.h"
+
+// steps a game on a background thread, a few steps ahead of whoever is
+// showing them
+//
+// Each step is handed over as a frame holding its own copy of the board,
+// so the caller can take its time with one frame while the next ones are
+// worked out. At most capacity frames wait at once.
+class StepPipeline {
+ public:
+  struct Frame {
+    // the board after the step
+    Board board;
+    // cells of board above
+    std::set<const Cell *> cells_changed;
+    std::vector<std::string> change_descriptions;
+    // the operators have nothing left to do; board is the final board
+    bool done;
+  };
+
+  StepPipeline(const Game& game, std::size_t capacity);
+  ~StepPipeline();
+
+  StepPipeline(const StepPipeline&) = delete;
+  StepPipeline& operator=(const StepPipeline&) = delete;
+
+  // waits for the next frame; after the done frame, keeps returning it.
+  // Rethrows anything Game::Step threw, once the frames before it are used.
+  std::shared_ptr<const Frame> Next();
+
+ private:
+  void Produce();
+
+  // returns false if the pipeline is being stopped
+  bool Push(std::shared_ptr<const Frame> frame);
+
+  Game game_;
+  std::size_t capacity_;
+
+  std::mutex mutex_;
+  std::condition_variable changed_;
+  std::deque<std::shared_ptr<const Frame>> frames_;
+  std::shared_ptr<const Frame> last_frame_;
+  std::exception_ptr error_;
+  bool stopping_;
+
+  std::thread producer_;
+};
+
+#endif
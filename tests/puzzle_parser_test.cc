@@ -0,0 +1,121 @@
+#include <cstdlib>  // for EXIT_SUCCESS, EXIT_FAILURE
+#include <iostream>
+#include <string>
+
+#include "../puzzle_parser.h"
+
+// a bad row in the middle of a grid is one error, and the puzzles after it
+// are still read from their first line
+static bool TestBadRowSkipsGrid() {
+  const std::string text =
+      "4 6 7 2 0 0 8 0 0\n"
+      "0 0 0 0 0 0 0 0 4\n"
+      "0 0 1 7 0 0 0 6 0\n"
+      "0 0 3 1 5 0 0 0 0\n"
+      "1 2 3\n"
+      "0 0 8 0 2 4 3 9 1\n"
+      "0 3 6 0 0 2 1 5 0\n"
+      "7 4 2 5 3 0 0 8 9\n"
+      "0 0 5 9 0 7 2 0 0\n"
+      "\n"
+      "# the next one is on a single line\n"
+      "4672008000000000041000000000000000000000000000000000000000000000000"
+      "00000000000000\n"
+      "\n"
+      "1 0 0 0 0 0 0 0 0\n"
+      "0 2 0 0 0 0 0 0 0\n"
+      "0 0 3 0 0 0 0 0 0\n"
+      "0 0 0 4 0 0 0 0 0\n"
+      "0 0 0 0 5 0 0 0 0\n"
+      "0 0 0 0 0 6 0 0 0\n"
+      "0 0 0 0 0 0 7 0 0\n"
+      "0 0 0 0 0 0 0 8 0\n"
+      "0 0 0 0 0 0 0 0 9\n";
+
+  PuzzleParser parser(text.data(), text.data() + text.size());
+  PuzzleParser::Puzzle puzzle;
+  bool ok = true;
+
+  try {
+    parser.Next(&puzzle);
+    std::cerr << "expected an error for the short row\n";
+    ok = false;
+  } catch (const PuzzleParser::ParseError& e) {
+    if (e.line() != 5) {
+      std::cerr << "error on line " << e.line() << ", expected 5\n";
+      ok = false;
+    }
+  }
+
+  if (!parser.Next(&puzzle) || parser.puzzle_line() != 12 ||
+      puzzle[0] != 4 || puzzle[1] != 6) {
+    std::cerr << "the single line puzzle wasn't read\n";
+    ok = false;
+  }
+
+  if (!parser.Next(&puzzle) || parser.puzzle_line() != 14 ||
+      puzzle[0] != 1 || puzzle[80] != 9) {
+    std::cerr << "the grid after it wasn't read\n";
+    ok = false;
+  }
+
+  if (parser.Next(&puzzle)) {
+    std::cerr << "expected no more puzzles\n";
+    ok = false;
+  }
+
+  return ok;
+}
+
+// a grid cut short by a line with a whole puzzle is one error, and that
+// line's puzzle is still read
+static bool TestWholePuzzleEndsGrid() {
+  const std::string line1 =
+      "1000000000000000000000000000000000000000000000000000000000000000000"
+      "00000000000000";
+  const std::string line2 =
+      "2000000000000000000000000000000000000000000000000000000000000000000"
+      "00000000000000";
+  const std::string text =
+      "4 6 7 2 0 0 8 0 0\n"
+      "0 0 0 0 0 0 0 0 4\n" + line1 + "\n" + line2 + "\n";
+
+  PuzzleParser parser(text.data(), text.data() + text.size());
+  PuzzleParser::Puzzle puzzle;
+  bool ok = true;
+
+  try {
+    parser.Next(&puzzle);
+    std::cerr << "expected an error for the short grid\n";
+    ok = false;
+  } catch (const PuzzleParser::ParseError& e) {
+    if (e.line() != 3) {
+      std::cerr << "error on line " << e.line() << ", expected 3\n";
+      ok = false;
+    }
+  }
+
+  if (!parser.Next(&puzzle) || parser.puzzle_line() != 3 || puzzle[0] != 1) {
+    std::cerr << "the puzzle that ended the grid wasn't read\n";
+    ok = false;
+  }
+
+  if (!parser.Next(&puzzle) || parser.puzzle_line() != 4 || puzzle[0] != 2) {
+    std::cerr << "the puzzle after it wasn't read\n";
+    ok = false;
+  }
+
+  if (parser.Next(&puzzle)) {
+    std::cerr << "expected no more puzzles\n";
+    ok = false;
+  }
+
+  return ok;
+}
+
+int main() {
+  bool ok = TestBadRowSkipsGrid();
+  ok = TestWholePuzzleEndsGrid() && ok;
+  std::cout << (ok ? "PASS" : "FAIL") << std::endl;
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,43 @@
+#include "trail.h"
+
+#include "board.h"
+
+Trail::Trail() {
+  // enough for every cell to lose every guess and then be solved
+  entries_.reserve(81 * 10);
+}
+
+Trail::Mark Trail::mark() const {
+  return entries_.size();
+}
+
+std::size_t Trail::size() const {
+  return entries_.size();
+}
+
+void Trail::Record(Board *board, Cell *cell) {
+  if (cell->solved())
+    entries_.push_back({board, cell, {}, cell->solution(), true});
+  else
+    entries_.push_back({board, cell, cell->guesses(), 0, false});
+}
+
+void Trail::Undo(Mark mark) {
+  while (entries_.size() > mark) {
+    const Entry& entry = entries_.back();
+
+    if (entry.solved) {
+      entry.cell->set_solution(entry.solution);
+    } else {
+      entry.cell->set_unsolved();
+      entry.cell->set_guesses(entry.guesses);
+    }
+    entry.board->UpdateCandidates(entry.cell);
+
+    entries_.pop_back();
+  }
+}
+
+void Trail::Clear() {
+  entries_.clear();
+}
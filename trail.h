@@ -0,0 +1,42 @@
+#ifndef TRAIL_H_
+#define TRAIL_H_
+
+#include <cstddef>  // for std::size_t
+#include <vector>
+
+#include "cell.h"
+
+class Board;
+
+// undo log of the changes made to a board
+//
+// While a trail is attached to a board, every change made through the
+// board's mutators first records the previous state of the cell. Undo
+// restores the board to an earlier mark in time proportional to the number
+// of changes made since, no matter how large the board is.
+class Trail {
+ public:
+  using Mark = std::size_t;
+
+  Trail();
+
+  Mark mark() const;
+  std::size_t size() const;
+
+  void Record(Board *board, Cell *cell);
+  void Undo(Mark mark);
+  void Clear();
+
+ private:
+  struct Entry {
+    Board *board;
+    Cell *cell;
+    Cell::CellGuesses guesses;
+    int solution;
+    bool solved;
+  };
+
+  std::vector<Entry> entries_;
+};
+
+#endif